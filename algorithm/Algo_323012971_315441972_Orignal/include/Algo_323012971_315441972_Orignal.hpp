@@ -7,9 +7,15 @@ public:
     virtual ~Algo_323012971_315441972_Orignal() {}
 
 protected:
-    std::optional<Step> findStepToNearestDirtyTile() const;
+    std::optional<Step> findStepToNearestDirtyTileOrUnknown() const;
     virtual Step calculateNextStep() override;
+    bool isPlanStillValid() const override { return isMappingStage() == plannedInMappingStage; };
 
 private:
     bool isMappingStage() const;
+    /**
+     * The stage the last step was decided in, the stage also ends by the number of steps taken so a plan can outlive it
+     */
+    bool plannedInMappingStage = false;
+    bool isReachableDirtyTile(const Coordinate<int32_t> &coordinate, const BFSResult &searchResult) const;
 };
\ No newline at end of file
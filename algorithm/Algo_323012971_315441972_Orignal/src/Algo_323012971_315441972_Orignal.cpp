@@ -1,29 +1,28 @@
 #include "Algo_323012971_315441972_Orignal.hpp"
 #include "AlgorithmRegistration.h"
-std::optional<Step> Algo_323012971_315441972_Orignal::findStepToNearestDirtyTile() const
+bool Algo_323012971_315441972_Orignal::isReachableDirtyTile(const Coordinate<int32_t> &coordinate, const BFSResult &searchResult) const
+{
+    const auto &locationMapping = getNoWallGraph().getVertex(coordinate);
+    bool canReachAndReturn = stepsUntilMustBeOnCharger(searchResult.getDistance()) > getLengthToCharger(coordinate);
+    bool isDirtyTile = locationMapping.getHouseLocation().getLocationType() == LocationType::HOUSE_TILE &&
+                       locationMapping.getHouseLocation().getDirtLevel() > 0;
+    return canReachAndReturn && isDirtyTile;
+}
+/**
+    A dirty tile comes before any unknown one, both are looked for in the same BFS
+ */
+std::optional<Step> Algo_323012971_315441972_Orignal::findStepToNearestDirtyTileOrUnknown() const
 {
     if (!isExistsMappedCleanableTile())
     {
-        return std::nullopt;
-    }
-
-    const auto &graph = getNoWallGraph();
-
-    auto condition = [&](const Coordinate<int32_t> &coordinate, const BFSResult &searchResult)
-    {
-        auto locationMapping = graph.getVertex(coordinate);
-        bool canReachAndReturn = stepsUntilMustBeOnCharger(searchResult.getDistance()) > getLengthToCharger(coordinate);
-        bool isDirtyTile = locationMapping.getHouseLocation().getLocationType() == LocationType::HOUSE_TILE &&
-                           locationMapping.getHouseLocation().getDirtLevel() > 0;
-        return canReachAndReturn && isDirtyTile;
-    };
-
-    auto step = findStepToNearestMatchingTile(condition);
-    if (step.has_value())
-    {
-        return step;
+        return getStepTowardsClosestReachableUnknown();
     }
-    return std::nullopt;
+    const BFSPredicate conditions[] = {
+        [&](const Coordinate<int32_t> &coordinate, const BFSResult &searchResult)
+        { return isReachableDirtyTile(coordinate, searchResult); },
+        [&](const Coordinate<int32_t> &coordinate, const BFSResult &searchResult)
+        { return isReachableUnknownTile(coordinate, searchResult); }};
+    return findStepToNearestMatchingTile(conditions);
 }
 
 Step Algo_323012971_315441972_Orignal::calculateNextStep()
@@ -36,6 +35,7 @@ Step Algo_323012971_315441972_Orignal::calculateNextStep()
             * when the battery is NOT full and we are on the charger
             * Finishing correctly, we are on the charger and for any reason no more progress is possible
      */
+    plannedInMappingStage = isMappingStage();
     std::optional<Step> forcedMove = getForcedMove();
     if (forcedMove.has_value())
     {
@@ -47,7 +47,7 @@ Step Algo_323012971_315441972_Orignal::calculateNextStep()
         In the cleaning stage we clean any tile we are on to completion moving on the next closest tile
     */
     std::optional<Step> step;
-    if (isMappingStage())
+    if (plannedInMappingStage)
     {
         /**
             Note the REACHABLE part, we do not want to start moving to a tile only to run out of battery before we can clean it
@@ -57,11 +57,7 @@ Step Algo_323012971_315441972_Orignal::calculateNextStep()
     }
     else
     {
-        step = findStepToNearestDirtyTile();
-        if (!step.has_value())
-        {
-            step = getStepTowardsClosestReachableUnknown();
-        }
+        step = findStepToNearestDirtyTileOrUnknown();
     }
     if (step.has_value())
     {
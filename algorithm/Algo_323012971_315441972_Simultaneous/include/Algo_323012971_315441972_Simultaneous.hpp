@@ -8,4 +8,7 @@ public:
 protected:
     std::optional<Step> findStepToNearestDirtyOrUnknownTile() const ;
     virtual Step calculateNextStep() override;
+
+private:
+    bool isReachableDirtyOrUnknownTile(const Coordinate<int32_t>& coordinate, const BFSResult& searchResult) const;
 };
\ No newline at end of file
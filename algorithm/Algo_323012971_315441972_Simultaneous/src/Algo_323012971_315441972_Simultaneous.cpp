@@ -1,27 +1,25 @@
 #include "Algo_323012971_315441972_Simultaneous.hpp"
 #include "AlgorithmRegistration.h"
 
+bool Algo_323012971_315441972_Simultaneous::isReachableDirtyOrUnknownTile(const Coordinate<int32_t>& coordinate, const BFSResult& searchResult) const {
+    const auto& locationMapping = getNoWallGraph().getVertex(coordinate);
+    bool canReachAndReturn = stepsUntilMustBeOnCharger(searchResult.getDistance()) + 1 > getLengthToCharger(coordinate);
+    bool isDirtyTile = locationMapping.getHouseLocation().getLocationType() == LocationType::HOUSE_TILE &&
+                       locationMapping.getHouseLocation().getDirtLevel() > 0;
+    bool isUnmappedTile = locationMapping.getHouseLocation().getLocationType() == LocationType::UNKNOWN;
+    return canReachAndReturn && (isDirtyTile || isUnmappedTile);
+}
+
+/**
+ * Without a known dirty tile only an unknown one can match, which is exactly what getStepTowardsClosestReachableUnknown looks for
+ */
 std::optional<Step> Algo_323012971_315441972_Simultaneous::findStepToNearestDirtyOrUnknownTile() const {
     if (!isExistsMappedCleanableTile()) {
-        return std::nullopt;
-    }
-    const auto& graph = getNoWallGraph();
-    auto condition =  [&](const Coordinate<int32_t>& coordinate, const BFSResult& searchResult) {
-        auto locationMapping = graph.getVertex(coordinate);
-        bool canReachAndReturn = stepsUntilMustBeOnCharger(searchResult.getDistance()) + 1 > getLengthToCharger(coordinate);
-        bool isDirtyTile = locationMapping.getHouseLocation().getLocationType() == LocationType::HOUSE_TILE &&
-                           locationMapping.getHouseLocation().getDirtLevel() > 0;
-        bool isUnmappedTile = locationMapping.getHouseLocation().getLocationType() == LocationType::UNKNOWN;                   
-        return canReachAndReturn && (isDirtyTile || isUnmappedTile);
-        };
-
-    auto step = findStepToNearestMatchingTile(condition);
-
-    if (step.has_value())
-    {
-        return step;
+        return getStepTowardsClosestReachableUnknown();
     }
-    return std::nullopt;
+    return findStepToNearestMatchingTile([&](const Coordinate<int32_t>& coordinate, const BFSResult& searchResult) {
+        return isReachableDirtyOrUnknownTile(coordinate, searchResult);
+    });
 }
 
 
@@ -34,10 +32,6 @@ Step Algo_323012971_315441972_Simultaneous::calculateNextStep() {
         return *step;
     }
 
-    if (auto step = getStepTowardsClosestReachableUnknown()) {
-        return *step;
-    }
-
     if (isOnCharger()) {
         setFinished();
         return Step::Finish;
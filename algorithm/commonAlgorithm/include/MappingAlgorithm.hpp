@@ -1,9 +1,14 @@
 #pragma once
 #include "AbstractAlgorithm.h"
+#include "ChargingAlgorithm.h"
+#include "ChargingBatteryMeter.h"
+#include "SensorSnapshot.h"
+#include "PlanningAlgorithm.h"
 #include "MappingGraph.hpp"
 #include "Coordinate.hpp"
 #include "HouseLocation.hpp"
-class MappingAlgorithm : public AbstractAlgorithm
+#include <unordered_set>
+class MappingAlgorithm : public AbstractAlgorithm, public ChargingAlgorithm, public SensorSnapshotAlgorithm, public PlanningAlgorithm
 {
 public:
     ~MappingAlgorithm() override = default;
@@ -13,18 +18,29 @@ public:
     void setBatteryMeter(const BatteryMeter &meter) override
     {
         batteryMeter = &meter;
+        chargingBatteryMeter = dynamic_cast<const ChargingBatteryMeter *>(&meter);
         maxBattery = batteryMeter->getBatteryState();
     };
+    void setSensorSnapshot(const SensorSnapshot &snapshot) override { sensorSnapshot = &snapshot; };
     Step nextStep() override;
+    std::vector<Step> nextSteps() override;
+    bool continuePlan() override;
+    std::size_t takeChargeSteps(std::size_t maxChargeSteps) override;
 
 protected:
     virtual Step calculateNextStep() { return Step::Finish; };
     virtual std::optional<Step> getForcedMove() const;
+    /**
+     * Checked before every planned step after the first, an algorithm whose choice depends on more than the map,
+     * the battery and the charger drops the plan here once that changed
+     */
+    virtual bool isPlanStillValid() const { return true; };
 
     std::optional<Step> getStepTowardsClosestReachableUnknown() const;
 
     Step stepTowardsCharger() const;
-    Step getStepTowardsDestination(const Coordinate<int32_t> &destination, const std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>> results) const;
+    Step getStepTowardsDestination(const Coordinate<int32_t> &destination, const BFSView &results) const;
+    std::vector<Step> getPathTowardsDestination(const Coordinate<int32_t> &destination, const BFSView &results) const;
 
     const MappingGraph &getNoWallGraph() const { return noWallGraph; }
 
@@ -37,9 +53,12 @@ protected:
     void setFinished() { finished = true; };
     bool isCompletelyMapped() const;
     bool isExistsMappedCleanableTile() const;
+    bool isExistsMappedUnknownTile() const;
     bool isOnCharger() const;
 
-    std::optional<Step> findStepToNearestMatchingTile(const std::function<bool(const Coordinate<int32_t> &, const BFSResult &)> &predicate) const;
+    std::optional<Step> findStepToNearestMatchingTile(const BFSPredicate &predicate) const;
+    std::optional<Step> findStepToNearestMatchingTile(std::span<const BFSPredicate> predicates) const;
+    bool isReachableUnknownTile(const Coordinate<int32_t> &coordinate, const BFSResult &bfsResult) const;
 
 private:
     constexpr uint32_t maxReachableDistance() const { return maxBattery / 2; };
@@ -53,26 +72,58 @@ private:
     uint32_t stepsTaken = 0;
 
     const BatteryMeter *batteryMeter = nullptr;
+    const ChargingBatteryMeter *chargingBatteryMeter = nullptr;
+    const SensorSnapshot *sensorSnapshot = nullptr;
+    /**
+     * The sensors are read once at the start of every step, everything during the step uses these readings
+     */
+    SensorReadings readings;
     const WallsSensor *wallsSensor = nullptr;
     const DirtSensor *dirtSensor = nullptr;
 
     MappingGraph noWallGraph;
 
+    /**
+     * Mapped tiles still UNKNOWN and mapped HOUSE_TILEs with dirt, kept up to date as the surroundings are mapped
+     */
+    std::unordered_set<Coordinate<int32_t>> unknownTiles;
+    std::unordered_set<Coordinate<int32_t>> dirtyTiles;
+
     Coordinate<int32_t> relativeCoordinates = Coordinate<int32_t>(0, 0);
 
+    /**
+     * The path to the tile the last findStepToNearestMatchingTile picked, handed out by nextSteps as a plan
+     */
+    mutable std::vector<Step> plannedPath;
+    mutable Coordinate<int32_t> plannedDestination = Coordinate<int32_t>(0, 0);
+    std::size_t plannedPathPosition = 0;
+
     mutable bool finished = false;
     mutable bool isCompletelyMappedCache = false;
+    struct ChargerSurvey
+    {
+        bool isPotentiallyCleanableTile;
+        bool isProgressPossible;
+    };
+    /**
+     * What is within cleaning distance of the charger on the current map, cleared whenever the surroundings are mapped
+     */
+    mutable std::optional<ChargerSurvey> chargerSurvey;
+    const ChargerSurvey &getChargerSurvey() const;
 
     bool isFullyCharged() const;
+    bool isDoneChargingAfter(std::size_t chargeSteps) const;
     bool mustReturnToCharger() const;
     bool isWorthWhileStep(Step step) const;
     bool isProgressPossibleTheoretically() const;
-    bool isKnownCleanableTile(const HouseLocationMapping &locationMapping, BFSResult result) const;
-    bool isPotentiallyCleanableTile(const HouseLocationMapping &locationMapping, BFSResult result) const;
+    bool isAnyWithinCleaningDistance(const std::unordered_set<Coordinate<int32_t>> &tiles) const;
+    void indexLocation(Coordinate<int32_t> coordinate);
     void updateLocationIfExists(const HouseLocation &newLocation);
+    bool isMappingUpToDate() const;
     bool isSensorsSet() const { return wallsSensor && dirtSensor && batteryMeter; };
     bool isAtMaxSteps() const;
 
+    void readSensors();
     void mapDirection(Direction direction);
     void mapSurroundings();
     void mapCurrentLocation();
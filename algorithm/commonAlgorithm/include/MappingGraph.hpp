@@ -1,14 +1,15 @@
 #pragma once
 #include "Coordinate.hpp"
 #include "HouseLocationMapping.hpp"
+#include <array>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
-#include <set>
 typedef uint32_t vertexUID;
-class BFSNode;
+class BFSView;
 class MappingGraph;
 class BFSResult
 {
@@ -21,6 +22,11 @@ private:
     uint32_t distance;
     std::optional<Coordinate<int32_t>> parent;
 };
+typedef std::function<bool(const Coordinate<int32_t> &, const BFSResult &)> BFSPredicate;
+/**
+ * How many predicates one traversal can answer
+ */
+constexpr std::size_t MAX_BFS_QUERIES = 4;
 class Edge
 {
 public:
@@ -53,48 +59,97 @@ public:
     HouseLocationMapping &getVertex(Coordinate<int32_t> location);
     std::vector<MappingGraphEdge> getEdges(Coordinate<int32_t> v) const { return const_cast<MappingGraph *>(this)->iGetEdges(v); }
     bool isVertex(Coordinate<int32_t> location) const;
+    bool isEdge(Coordinate<int32_t> v, Direction direction) const;
     const HouseLocationMapping &getVertex(Coordinate<int32_t> location) const { return const_cast<MappingGraph *>(this)->iGetVertex(location); }
-    const std::vector<HouseLocationMapping> getMappings() const { return locations; }
-    uint32_t size() const { return adj.size(); }
-    std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>> bfs(Coordinate<int32_t> start) const;
-    std::pair<std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>>, std::unordered_map<Coordinate<int32_t>, BFSResult>::const_iterator> bfs_find_first(Coordinate<int32_t> startCoordinate, std::function<bool(const Coordinate<int32_t> &, const BFSResult &)> predicate) const;
+    const std::vector<HouseLocationMapping> &getMappings() const { return locations; }
+    uint32_t size() const { return locations.size(); }
+    /**
+     * Length of the shortest mapped path from the location to the charger, nullopt while there is none
+     */
+    std::optional<uint32_t> getChargerDistance(Coordinate<int32_t> location) const;
+    /**
+     * First step of that path, nullopt on the charger itself or while there is no path
+     */
+    std::optional<Direction> getDirectionTowardsCharger(Coordinate<int32_t> location) const;
+    /**
+     * The returned view reads the graph's search workspace, it is only valid until the next search on this graph
+     */
+    BFSView bfs(Coordinate<int32_t> start) const;
+    BFSView bfs_find_first(Coordinate<int32_t> startCoordinate, const BFSPredicate &predicate) const;
+    /**
+     * Finds the first match of every predicate in one traversal, which stops once all of them matched
+     */
+    BFSView bfs_find_each(Coordinate<int32_t> startCoordinate, std::span<const BFSPredicate> predicates) const;
+    /**
+     * Like bfs_find_each for predicates in order of preference, only the first predicate that matches anywhere is wanted,
+     * so the traversal also stops as soon as the first predicate matched
+     */
+    BFSView bfs_find_first_of(Coordinate<int32_t> startCoordinate, std::span<const BFSPredicate> predicates) const;
     ~MappingGraph() = default;
 
 private:
-    mutable std::unordered_map<Coordinate<int32_t>, std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>>> cache =
-        std::unordered_map<Coordinate<int32_t>, std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>>>();
-    void invalidateCache() const { cache.clear(); }
-    std::vector<std::set<vertexUID>> adj = std::vector<std::set<vertexUID>>();
-    std::unordered_map<Coordinate<int32_t>, vertexUID> locationToVertex = std::unordered_map<Coordinate<int32_t>, vertexUID>();
+    friend class BFSView;
+    /**
+     * One bit per Direction for every vertex, set when there is an edge to the neighbour in that direction
+     */
+    std::vector<uint8_t> neighbours = std::vector<uint8_t>();
     std::vector<HouseLocationMapping> locations = std::vector<HouseLocationMapping>();
-    std::unordered_map<Coordinate<int32_t>, BFSResult>::const_iterator bfsInternal(vertexUID start, std::unordered_map<Coordinate<int32_t>, BFSResult> &outMap, std::optional<std::function<bool(const Coordinate<int32_t> &, const BFSResult &)>> predicate) const;
-    std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>> bfsToResults(const std::vector<BFSNode> &bfsNodes) const;
+    /**
+     * Vertex of every cell of the box around the mapped area, NO_VERTEX for cells not mapped yet.
+     * The box grows with a margin on every side so mapping one more tile rarely copies it
+     */
+    std::vector<vertexUID> grid = std::vector<vertexUID>();
+    int32_t gridMinX = 0;
+    int32_t gridMinY = 0;
+    int32_t gridRows = 0;
+    int32_t gridCols = 0;
+    /**
+     * Shortest path tree rooted at the charger (the origin). The graph only grows, so a new edge can only shorten
+     * distances and the tree is relaxed from that edge instead of searched again
+     */
+    std::vector<uint32_t> chargerDistances = std::vector<uint32_t>();
+    std::vector<vertexUID> chargerParents = std::vector<vertexUID>();
+    void relaxChargerDistances(vertexUID v, vertexUID w);
+    vertexUID findVertex(Coordinate<int32_t> location) const;
+    vertexUID vertexAt(Coordinate<int32_t> location) const;
+    void growGrid(Coordinate<int32_t> location);
+    uint32_t getNeighbours(vertexUID vertex, vertexUID (&out)[4]) const;
+    /**
+     * Search workspace indexed by vertexUID and grown with the graph, so a search allocates nothing.
+     * A vertex was reached by the current search when its stamp equals searchEpoch, so nothing is cleared between searches.
+     * Every vertex is queued at most once per search, so the queue is an array as long as the graph
+     */
+    mutable std::vector<uint32_t> searchStamps = std::vector<uint32_t>();
+    mutable std::vector<uint32_t> searchDistances = std::vector<uint32_t>();
+    mutable std::vector<vertexUID> searchParents = std::vector<vertexUID>();
+    mutable std::vector<vertexUID> searchQueue = std::vector<vertexUID>();
+    mutable uint32_t searchEpoch = 0;
+    mutable bool searching = false;
+    BFSView bfsInternal(vertexUID start, std::span<const BFSPredicate> predicates, bool untilFirstMatches) const;
+    bool isReached(vertexUID vertex) const { return searchStamps[vertex] == searchEpoch; }
     HouseLocationMapping &iGetVertex(Coordinate<int32_t> location);
     std::vector<MappingGraphEdge> iGetEdges(Coordinate<int32_t> v);
-    std::pair<Coordinate<int32_t>, BFSResult> getBFSResult(const BFSNode &node) const;
 };
 
-class BFSNode
+/**
+ * Distances and parents of the last search on a graph
+ */
+class BFSView
 {
 public:
-    enum class Color
-    {
-        WHITE,
-        GRAY,
-        BLACK
-    };
-    void setColor(Color color) { this->color = color; }
-    void setDistance(uint32_t distance) { this->distance = distance; }
-    void setParent(vertexUID parent) { this->parent = parent; }
-    [[nodiscard]] Color getColor() const { return color; }
-    [[nodiscard]] vertexUID getVertex() const { return vertex; }
-    [[nodiscard]] uint32_t getDistance() const { return distance; }
-    [[nodiscard]] vertexUID getParent() const { return parent; }
-    BFSNode(vertexUID vertex) : vertex(vertex) {};
+    BFSView(const MappingGraph &graph, uint32_t epoch, const std::array<vertexUID, MAX_BFS_QUERIES> &found) : graph(&graph), epoch(epoch), found(found) {};
+    /**
+     * The query is the index of the predicate in the search that made the view
+     */
+    [[nodiscard]] bool isFound(std::size_t query = 0) const { return found.at(query) != MappingGraph::NO_VERTEX; }
+    [[nodiscard]] Coordinate<int32_t> getFound(std::size_t query = 0) const;
+    [[nodiscard]] bool contains(Coordinate<int32_t> location) const;
+    [[nodiscard]] uint32_t getDistance(Coordinate<int32_t> location) const;
+    [[nodiscard]] std::optional<Coordinate<int32_t>> getParent(Coordinate<int32_t> location) const;
 
 private:
-    const vertexUID vertex;
-    Color color = Color::WHITE;
-    uint32_t distance = UINT32_MAX;
-    vertexUID parent = MappingGraph::NO_VERTEX;
+    const MappingGraph *graph;
+    uint32_t epoch;
+    std::array<vertexUID, MAX_BFS_QUERIES> found;
+    vertexUID reachedVertex(Coordinate<int32_t> location) const;
 };
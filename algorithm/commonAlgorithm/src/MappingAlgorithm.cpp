@@ -53,10 +53,13 @@ std::optional<Step> MappingAlgorithm::getForcedMove() const
     {
         return Step::Finish;
     }
+    plannedPath.clear();
     /*
         This is free and should be done at every turn so it is not a part of calculate
     */
+    readSensors();
     mapSurroundings();
+    chargerSurvey.reset();
 
     /*
         This function is the bulk of the logic, take a look at the documentation inside
@@ -74,9 +77,113 @@ std::optional<Step> MappingAlgorithm::getForcedMove() const
     return step;
 }
 
+/**
+ * Standing on the charger getForcedMove keeps returning Stay until the battery is full (or enough for the remaining steps),
+ * nothing it looks at changes meanwhile except the battery and the step count, so the length of the whole charge is known up front
+ */
+std::size_t MappingAlgorithm::takeChargeSteps(std::size_t maxChargeSteps)
+{
+    if (chargingBatteryMeter == nullptr || finished || isAtMaxSteps() || !isOnCharger() || !isProgressPossibleTheoretically())
+    {
+        return 0;
+    }
+    std::size_t low = 0;
+    std::size_t high = std::min<std::size_t>(maxChargeSteps, maxSteps - stepsTaken);
+    if (!isDoneChargingAfter(high))
+    {
+        low = high;
+    }
+    /*
+        Being done charging only becomes more true the longer we charge, so binary search for the first step where it holds
+    */
+    while (low < high)
+    {
+        std::size_t middle = low + (high - low) / 2;
+        if (isDoneChargingAfter(middle))
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    stepsTaken += low;
+    return low;
+}
+bool MappingAlgorithm::isDoneChargingAfter(std::size_t chargeSteps) const
+{
+    std::size_t battery = chargingBatteryMeter->getBatteryStateAfterCharging(chargeSteps);
+    std::size_t stepsLeft = maxSteps - (stepsTaken + chargeSteps);
+    if (stepsLeft == 0)
+    {
+        return true;
+    }
+    // An empty battery means mustReturnToCharger, which also stays on the charger
+    return battery != 0 && (battery == maxBattery || battery >= stepsLeft);
+}
+/**
+ * The step returned by nextStep comes with the rest of the path towards the tile it was heading to
+ */
+std::vector<Step> MappingAlgorithm::nextSteps()
+{
+    Step step = nextStep();
+    if (plannedPath.empty() || plannedPath.front() != step)
+    {
+        plannedPath.clear();
+        return {step};
+    }
+    plannedPathPosition = 1;
+    return plannedPath;
+}
+/**
+ * Takes the next planned step only while nothing that getForcedMove or the target selection looks at has changed,
+ * otherwise nextStep has to decide again. The plan keeps to the tile it was heading to, where another tile is just as
+ * near a fresh search from a later tile may break the tie differently
+ */
+bool MappingAlgorithm::continuePlan()
+{
+    if (plannedPathPosition >= plannedPath.size() || finished || isAtMaxSteps() || isOnCharger() || !isPlanStillValid())
+    {
+        return false;
+    }
+    readSensors();
+    if (!isMappingUpToDate())
+    {
+        return false;
+    }
+    if (plannedDestination != getChargerLocation() && getLengthToCharger(relativeCoordinates) >= stepsUntilMustBeOnCharger(0))
+    {
+        return false;
+    }
+    Step step = plannedPath[plannedPathPosition++];
+    stepsTaken++;
+    relativeCoordinates = relativeCoordinates.getStep(step);
+    return true;
+}
+bool MappingAlgorithm::isMappingUpToDate() const
+{
+    if (!noWallGraph.isVertex(relativeCoordinates))
+    {
+        return false;
+    }
+    const auto &location = noWallGraph.getVertex(relativeCoordinates).getHouseLocation();
+    if (location.getLocationType() != LocationType::HOUSE_TILE || location.getDirtLevel() != readings.dirtLevel)
+    {
+        return false;
+    }
+    for (auto direction : {Direction::North, Direction::East, Direction::South, Direction::West})
+    {
+        if (!readings.isWall(direction) && !noWallGraph.isEdge(relativeCoordinates, direction))
+        {
+            return false;
+        }
+    }
+    return true;
+}
 bool MappingAlgorithm::isFullyCharged() const
 {
-    return batteryMeter->getBatteryState() == maxBattery || batteryMeter->getBatteryState() >= maxSteps - stepsTaken;
+    return readings.batteryState == maxBattery || readings.batteryState >= maxSteps - stepsTaken;
 }
 bool MappingAlgorithm::isOnCharger() const
 {
@@ -86,9 +193,9 @@ uint32_t MappingAlgorithm::stepsUntilMustBeOnCharger(uint32_t offeset) const
 {
     uint32_t battery = 0;
     uint32_t localMaxSteps = 0;
-    if (batteryMeter->getBatteryState() > offeset)
+    if (readings.batteryState > offeset)
     {
-        battery = batteryMeter->getBatteryState() - offeset;
+        battery = readings.batteryState - offeset;
     }
     if (maxSteps > (stepsTaken + offeset))
     {
@@ -102,130 +209,145 @@ uint32_t MappingAlgorithm::stepsUntilMustBeOnCharger(uint32_t offeset) const
 
 bool MappingAlgorithm::mustReturnToCharger() const
 {
-    auto [results, iterator] = noWallGraph.bfs_find_first(relativeCoordinates, std::function<bool(const Coordinate<int32_t> &, const BFSResult &)>(
-                                                                                   [&](const Coordinate<int32_t> &coordinate, const BFSResult &)
-                                                                                   {
-                                                                                       return coordinate == getChargerLocation();
-                                                                                   }));
-    return iterator->second.getDistance() >= stepsUntilMustBeOnCharger(0);
+    return getLengthToCharger(relativeCoordinates) >= stepsUntilMustBeOnCharger(0);
 }
 
+/**
+ * Follows the charger tree of the graph, the whole way back is kept as the plan
+ */
 Step MappingAlgorithm::stepTowardsCharger() const
 {
-    auto condition = [&](const Coordinate<int32_t> &coordinate, const BFSResult &)
-    { return coordinate == getChargerLocation(); };
-    auto step = findStepToNearestMatchingTile(condition);
-    if (step.has_value())
+    plannedPath.clear();
+    plannedDestination = getChargerLocation();
+    Coordinate<int32_t> coordinate = relativeCoordinates;
+    while (coordinate != getChargerLocation())
     {
-        return step.value();
+        auto direction = noWallGraph.getDirectionTowardsCharger(coordinate);
+        if (!direction.has_value())
+        {
+            throw std::runtime_error("Could not find path to charger in the charger tree");
+        }
+        plannedPath.push_back(DirectionTools::toStep(*direction));
+        coordinate = coordinate.getDirection(*direction);
     }
-    throw std::runtime_error("Could not find path to charger in BFS results");
+    if (plannedPath.empty())
+    {
+        return Step::Stay;
+    }
+    return plannedPath.front();
 }
 uint32_t MappingAlgorithm::getLengthToCharger(Coordinate<int32_t> from) const
 {
-    auto result = noWallGraph.bfs(getChargerLocation());
-
-    if (result == nullptr || !result->contains(from))
+    auto distance = noWallGraph.getChargerDistance(from);
+    if (!distance.has_value())
     {
-        throw std::runtime_error("Could not find path to charger in BFS results");
+        throw std::runtime_error("Could not find path to charger in the charger tree");
     }
-    return result->at(from).getDistance();
+    return *distance;
 }
 bool MappingAlgorithm::isExistsMappedCleanableTile() const
 {
-    for (const auto &mapping : noWallGraph.getMappings())
-    {
-        if (mapping.getHouseLocation().getLocationType() == LocationType::HOUSE_TILE && mapping.getHouseLocation().getDirtLevel() > 0)
-        {
-            return true;
-        }
-    }
-    return false;
+    return !dirtyTiles.empty();
+}
+bool MappingAlgorithm::isExistsMappedUnknownTile() const
+{
+    return !unknownTiles.empty();
 }
 bool MappingAlgorithm::isCompletelyMapped() const
 {
-    if (isCompletelyMappedCache)
+    return isCompletelyMappedCache || !getChargerSurvey().isPotentiallyCleanableTile;
+}
+bool MappingAlgorithm::isProgressPossibleTheoretically() const
+{
+    return getChargerSurvey().isProgressPossible;
+}
+/**
+ * Both charger questions are about the indexed tiles only, and the charger tree has their distances, so no search is needed.
+ * The answers hold until the surroundings are mapped again, nothing else changes the map.
+ * Once no unknown tile is within cleaning distance none will ever be, so the house is completely mapped for good
+ */
+const MappingAlgorithm::ChargerSurvey &MappingAlgorithm::getChargerSurvey() const
+{
+    if (chargerSurvey.has_value())
     {
-        return true;
+        return *chargerSurvey;
     }
-    auto [results, iterator] = noWallGraph.bfs_find_first(getChargerLocation(), std::function<bool(const Coordinate<int32_t> &, const BFSResult &)>(
-                                                                                    [&](const Coordinate<int32_t> &coordinate, const BFSResult &bfsResult)
-                                                                                    {
-                                                                                        auto locationMapping = noWallGraph.getVertex(coordinate);
-                                                                                        return isPotentiallyCleanableTile(locationMapping, bfsResult);
-                                                                                    }));
-    isCompletelyMappedCache = iterator == results->end();
-    return isCompletelyMappedCache;
+    bool isPotentiallyCleanableTile = !isCompletelyMappedCache && isAnyWithinCleaningDistance(unknownTiles);
+    chargerSurvey = ChargerSurvey{isPotentiallyCleanableTile, isPotentiallyCleanableTile || isAnyWithinCleaningDistance(dirtyTiles)};
+    isCompletelyMappedCache = !isPotentiallyCleanableTile;
+    return *chargerSurvey;
 }
-bool MappingAlgorithm::isProgressPossibleTheoretically() const
+bool MappingAlgorithm::isAnyWithinCleaningDistance(const std::unordered_set<Coordinate<int32_t>> &tiles) const
 {
-    auto [results, iterator] = noWallGraph.bfs_find_first(getChargerLocation(), std::function<bool(const Coordinate<int32_t> &, const BFSResult &)>(
-                                                                                    [&](const Coordinate<int32_t> &coordinate, const BFSResult &bfsResult)
-                                                                                    {
-                                                                                        auto locationMapping = noWallGraph.getVertex(coordinate);
-                                                                                        return (isKnownCleanableTile(locationMapping, bfsResult) || isPotentiallyCleanableTile(locationMapping, bfsResult));
-                                                                                    }));
-    return iterator != results->end();
+    for (const auto &tile : tiles)
+    {
+        auto distance = noWallGraph.getChargerDistance(tile);
+        if (distance.has_value() && *distance <= maxCleanableDistance())
+        {
+            return true;
+        }
+    }
+    return false;
 }
 bool MappingAlgorithm::isAtMaxSteps() const
 {
     return stepsTaken >= maxSteps;
 }
-bool MappingAlgorithm::isKnownCleanableTile(const HouseLocationMapping &locationMapping, BFSResult result) const
-{
-    return locationMapping.getHouseLocation().getLocationType() == LocationType::HOUSE_TILE && locationMapping.getHouseLocation().getDirtLevel() > 0 && result.getDistance() <= maxCleanableDistance();
-}
-bool MappingAlgorithm::isPotentiallyCleanableTile(const HouseLocationMapping &locationMapping, BFSResult result) const
+bool MappingAlgorithm::isReachableUnknownTile(const Coordinate<int32_t> &coordinate, const BFSResult &bfsResult) const
 {
-    return locationMapping.getHouseLocation().getLocationType() == LocationType::UNKNOWN && (result.getDistance() <= maxCleanableDistance());
+    return noWallGraph.getVertex(coordinate).getHouseLocation().getLocationType() == LocationType::UNKNOWN &&
+           stepsUntilMustBeOnCharger(bfsResult.getDistance()) >= getLengthToCharger(coordinate);
 }
 std::optional<Step> MappingAlgorithm::getStepTowardsClosestReachableUnknown() const
 {
-    auto condition = [&](const Coordinate<int32_t> &coordinate, const BFSResult &bfsResult)
+    if (!isExistsMappedUnknownTile())
     {
-                    auto locationMapping = noWallGraph.getVertex(coordinate);
-                    return stepsUntilMustBeOnCharger(bfsResult.getDistance()) >= getLengthToCharger(coordinate)
-                     && locationMapping.getHouseLocation().getLocationType() == LocationType::UNKNOWN; };
-    auto step = findStepToNearestMatchingTile(condition);
-    if (step.has_value())
+        plannedPath.clear();
+        return std::nullopt;
+    }
+    return findStepToNearestMatchingTile([&](const Coordinate<int32_t> &coordinate, const BFSResult &bfsResult)
+                                         { return isReachableUnknownTile(coordinate, bfsResult); });
+}
+Step MappingAlgorithm::getStepTowardsDestination(const Coordinate<int32_t> &destination, const BFSView &results) const
+{
+    auto path = getPathTowardsDestination(destination, results);
+    if (path.empty())
     {
-        return step;
+        return Step::Stay;
     }
-    return std::nullopt;
+    return path.front();
 }
-Step MappingAlgorithm::getStepTowardsDestination(const Coordinate<int32_t> &destination, const std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>> results) const
+std::vector<Step> MappingAlgorithm::getPathTowardsDestination(const Coordinate<int32_t> &destination, const BFSView &results) const
 {
     if (relativeCoordinates == destination)
     {
-        return Step::Stay;
+        return {};
     }
-    auto vertexIterator = results->find(destination);
-    if (vertexIterator == results->end())
+    if (!results.contains(destination))
     {
         throw std::runtime_error("Could not find path to destinationv in BFS results");
     }
-    while (vertexIterator->second.getDistance() != 1)
+    std::vector<Step> path(results.getDistance(destination));
+    Coordinate<int32_t> coordinate = destination;
+    for (uint32_t distance = path.size(); distance != 0; distance--)
     {
-        auto nextStepCoordinates = vertexIterator->second.getParent();
+        auto nextStepCoordinates = results.getParent(coordinate);
         if (!nextStepCoordinates)
         {
             throw std::runtime_error("Could not find parent of node that is not root");
         }
-        vertexIterator = results->find(*nextStepCoordinates);
-        if (vertexIterator == results->end())
-        {
-            throw std::runtime_error("Could not find parent of node that is not root");
-        }
+        path[distance - 1] = DirectionTools::toStep(nextStepCoordinates->getDirection(coordinate));
+        coordinate = *nextStepCoordinates;
     }
-    Direction direction = relativeCoordinates.getDirection((*vertexIterator).first);
-    return DirectionTools::toStep(direction);
+    return path;
 }
 void MappingAlgorithm::mapCurrentLocation()
 {
-    HouseLocation location = HouseLocation(LocationType::HOUSE_TILE, dirtSensor->dirtLevel());
+    HouseLocation location = HouseLocation(LocationType::HOUSE_TILE, readings.dirtLevel);
     updateLocationIfExists(location);
     if (noWallGraph.isVertex(relativeCoordinates))
     {
+        indexLocation(relativeCoordinates);
         return;
     }
 
@@ -234,12 +356,13 @@ void MappingAlgorithm::mapCurrentLocation()
         location = HouseLocation(LocationType::CHARGING_STATION);
     }
     noWallGraph.addVertex(HouseLocationMapping(relativeCoordinates, location));
+    indexLocation(relativeCoordinates);
 }
 void MappingAlgorithm::mapDirection(Direction direction)
 {
     auto newLocationPair = relativeCoordinates.getDirection(direction);
     HouseLocation location = HouseLocation(LocationType::UNKNOWN);
-    if (wallsSensor->isWall(direction))
+    if (readings.isWall(direction))
     {
         location = HouseLocation(LocationType::WALL);
     }
@@ -248,6 +371,7 @@ void MappingAlgorithm::mapDirection(Direction direction)
         if (location.getLocationType() != LocationType::WALL)
         {
             noWallGraph.addVertex(HouseLocationMapping(newLocationPair, location));
+            indexLocation(newLocationPair);
         }
     }
     /**
@@ -258,6 +382,29 @@ void MappingAlgorithm::mapDirection(Direction direction)
         noWallGraph.addEdge(relativeCoordinates, direction);
     }
 }
+/**
+ * Keeps the tile in the index of its current type, every change of a mapped location goes through here
+ */
+void MappingAlgorithm::indexLocation(Coordinate<int32_t> coordinate)
+{
+    const auto &location = std::as_const(noWallGraph).getVertex(coordinate).getHouseLocation();
+    if (location.getLocationType() == LocationType::UNKNOWN)
+    {
+        unknownTiles.insert(coordinate);
+    }
+    else
+    {
+        unknownTiles.erase(coordinate);
+    }
+    if (location.getLocationType() == LocationType::HOUSE_TILE && location.getDirtLevel() > 0)
+    {
+        dirtyTiles.insert(coordinate);
+    }
+    else
+    {
+        dirtyTiles.erase(coordinate);
+    }
+}
 void MappingAlgorithm::updateLocationIfExists(const HouseLocation &newLocation)
 {
     if (!noWallGraph.isVertex(relativeCoordinates))
@@ -270,20 +417,51 @@ void MappingAlgorithm::updateLocationIfExists(const HouseLocation &newLocation)
     noWallVertex.update(newLocation);
 }
 
-std::optional<Step> MappingAlgorithm::findStepToNearestMatchingTile(const std::function<bool(const Coordinate<int32_t> &, const BFSResult &)> &predicate) const
+std::optional<Step> MappingAlgorithm::findStepToNearestMatchingTile(const BFSPredicate &predicate) const
 {
-
-    auto [results, iterator] = noWallGraph.bfs_find_first(relativeCoordinates, predicate);
-
-    if (iterator == results->end())
+    return findStepToNearestMatchingTile(std::span<const BFSPredicate>(&predicate, 1));
+}
+/**
+ * Heads for the nearest tile matching the first predicate that matches any tile, all from one traversal
+ */
+std::optional<Step> MappingAlgorithm::findStepToNearestMatchingTile(std::span<const BFSPredicate> predicates) const
+{
+    auto results = noWallGraph.bfs_find_first_of(relativeCoordinates, predicates);
+    for (std::size_t query = 0; query < predicates.size(); query++)
     {
-        return std::nullopt;
+        if (results.isFound(query))
+        {
+            plannedPath = getPathTowardsDestination(results.getFound(query), results);
+            plannedDestination = results.getFound(query);
+            if (plannedPath.empty())
+            {
+                return Step::Stay;
+            }
+            return plannedPath.front();
+        }
     }
-
-    Step step = getStepTowardsDestination(iterator->first, results);
-    return step;
+    plannedPath.clear();
+    return std::nullopt;
 }
 
+void MappingAlgorithm::readSensors()
+{
+    if (sensorSnapshot)
+    {
+        readings = sensorSnapshot->getSensorReadings();
+        return;
+    }
+    readings = SensorReadings();
+    for (auto direction : {Direction::North, Direction::East, Direction::South, Direction::West})
+    {
+        if (wallsSensor->isWall(direction))
+        {
+            readings.wallMask |= 1 << static_cast<uint8_t>(direction);
+        }
+    }
+    readings.dirtLevel = dirtSensor->dirtLevel();
+    readings.batteryState = batteryMeter->getBatteryState();
+}
 void MappingAlgorithm::mapSurroundings()
 {
     mapCurrentLocation();
@@ -1,152 +1,351 @@
 #include "MappingGraph.hpp"
 #include "Coordinate.hpp"
 #include "Direction.hpp"
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <optional>
 #include <queue>
+#include <stdexcept>
 #include <sys/types.h>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+namespace
+{
+    constexpr Direction DIRECTIONS[] = {Direction::North, Direction::East, Direction::South, Direction::West};
+    constexpr int32_t GRID_MARGIN = 8;
+    constexpr uint32_t UNREACHABLE = UINT32_MAX;
+    uint8_t directionBit(Direction direction) { return 1 << static_cast<uint8_t>(direction); }
+    Direction opposite(Direction direction) { return static_cast<Direction>((static_cast<uint8_t>(direction) + 2) % 4); }
+}
+vertexUID MappingGraph::findVertex(Coordinate<int32_t> location) const
+{
+    int64_t row = static_cast<int64_t>(location.getX()) - gridMinX;
+    int64_t col = static_cast<int64_t>(location.getY()) - gridMinY;
+    if (row < 0 || col < 0 || row >= gridRows || col >= gridCols)
+    {
+        return NO_VERTEX;
+    }
+    return grid[row * gridCols + col];
+}
+vertexUID MappingGraph::vertexAt(Coordinate<int32_t> location) const
+{
+    vertexUID vertex = findVertex(location);
+    if (vertex == NO_VERTEX)
+    {
+        throw std::out_of_range("No vertex at location");
+    }
+    return vertex;
+}
+void MappingGraph::growGrid(Coordinate<int32_t> location)
+{
+    bool inGrid = location.getX() >= gridMinX && location.getX() < gridMinX + gridRows &&
+                  location.getY() >= gridMinY && location.getY() < gridMinY + gridCols;
+    if (inGrid)
+    {
+        return;
+    }
+    int32_t minX = location.getX();
+    int32_t minY = location.getY();
+    int32_t maxX = location.getX();
+    int32_t maxY = location.getY();
+    if (gridRows > 0)
+    {
+        minX = std::min(minX, gridMinX);
+        minY = std::min(minY, gridMinY);
+        maxX = std::max(maxX, gridMinX + gridRows - 1);
+        maxY = std::max(maxY, gridMinY + gridCols - 1);
+    }
+    int32_t marginX = std::max((maxX - minX + 1) / 2, GRID_MARGIN);
+    int32_t marginY = std::max((maxY - minY + 1) / 2, GRID_MARGIN);
+    minX -= marginX;
+    minY -= marginY;
+    int32_t rows = maxX - minX + 1 + marginX;
+    int32_t cols = maxY - minY + 1 + marginY;
+    std::vector<vertexUID> grown(static_cast<std::size_t>(rows) * cols, vertexUID(NO_VERTEX));
+    for (int32_t row = 0; row < gridRows; row++)
+    {
+        std::copy_n(grid.begin() + static_cast<std::size_t>(row) * gridCols, gridCols,
+                    grown.begin() + static_cast<std::size_t>(row + gridMinX - minX) * cols + (gridMinY - minY));
+    }
+    grid = std::move(grown);
+    gridMinX = minX;
+    gridMinY = minY;
+    gridRows = rows;
+    gridCols = cols;
+}
+/**
+ * In the order the neighbours were added to the graph, which is the order a BFS visits them in
+ */
+uint32_t MappingGraph::getNeighbours(vertexUID vertex, vertexUID (&out)[4]) const
+{
+    uint32_t count = 0;
+    Coordinate<int32_t> location = locations[vertex].getRelativeToCharger();
+    for (Direction direction : DIRECTIONS)
+    {
+        if (neighbours[vertex] & directionBit(direction))
+        {
+            vertexUID neighbour = findVertex(location.getDirection(direction));
+            uint32_t i = count++;
+            for (; i > 0 && out[i - 1] > neighbour; i--)
+            {
+                out[i] = out[i - 1];
+            }
+            out[i] = neighbour;
+        }
+    }
+    return count;
+}
 void MappingGraph::addEdge(Coordinate<int32_t> v, Direction direction)
 {
-    invalidateCache();
     Coordinate<int32_t> w = v.getDirection(direction);
-    vertexUID vertexUidv = locationToVertex.at(v);
-    vertexUID vertexUidw = locationToVertex.at(w);
-    adj.at(vertexUidv).insert(vertexUidw);
-    adj.at(vertexUidw).insert(vertexUidv);
+    vertexUID vertexUidv = vertexAt(v);
+    vertexUID vertexUidw = vertexAt(w);
+    neighbours[vertexUidv] |= directionBit(direction);
+    neighbours[vertexUidw] |= directionBit(opposite(direction));
+    relaxChargerDistances(vertexUidv, vertexUidw);
+}
+/**
+ * Only vertices whose path through the new edge is shorter change, and their new paths all pass through its far end,
+ * so a BFS from there that stops at vertices it does not improve fixes the whole tree
+ */
+void MappingGraph::relaxChargerDistances(vertexUID v, vertexUID w)
+{
+    if (chargerDistances[v] > chargerDistances[w])
+    {
+        std::swap(v, w);
+    }
+    if (chargerDistances[v] == UNREACHABLE || chargerDistances[v] + 1 >= chargerDistances[w])
+    {
+        return;
+    }
+    chargerDistances[w] = chargerDistances[v] + 1;
+    chargerParents[w] = v;
+    std::queue<vertexUID> queue;
+    queue.push(w);
+    while (!queue.empty())
+    {
+        vertexUID u = queue.front();
+        queue.pop();
+        vertexUID targets[4];
+        uint32_t targetCount = getNeighbours(u, targets);
+        for (uint32_t i = 0; i < targetCount; i++)
+        {
+            vertexUID target = targets[i];
+            if (chargerDistances[u] + 1 < chargerDistances[target])
+            {
+                chargerDistances[target] = chargerDistances[u] + 1;
+                chargerParents[target] = u;
+                queue.push(target);
+            }
+        }
+    }
+}
+std::optional<uint32_t> MappingGraph::getChargerDistance(Coordinate<int32_t> location) const
+{
+    vertexUID vertex = findVertex(location);
+    if (vertex == NO_VERTEX || chargerDistances[vertex] == UNREACHABLE)
+    {
+        return std::nullopt;
+    }
+    return chargerDistances[vertex];
+}
+std::optional<Direction> MappingGraph::getDirectionTowardsCharger(Coordinate<int32_t> location) const
+{
+    vertexUID vertex = findVertex(location);
+    if (vertex == NO_VERTEX || chargerParents[vertex] == NO_VERTEX)
+    {
+        return std::nullopt;
+    }
+    return location.getDirection(locations[chargerParents[vertex]].getRelativeToCharger());
 }
 HouseLocationMapping &MappingGraph::getVertex(Coordinate<int32_t> location)
 {
-    invalidateCache();
-    return locations.at(locationToVertex.at(location));
+    return locations.at(vertexAt(location));
 }
 
 HouseLocationMapping &MappingGraph::iGetVertex(Coordinate<int32_t> location)
 {
-    return locations.at(locationToVertex.at(location));
+    return locations.at(vertexAt(location));
 }
 void MappingGraph::addVertex(const HouseLocationMapping &location)
 {
-    invalidateCache();
+    Coordinate<int32_t> locationCoordinate = location.getRelativeToCharger();
+    if (findVertex(locationCoordinate) != NO_VERTEX)
+    {
+        return;
+    }
     uint32_t vertexUid = size();
     locations.push_back(location);
-    adj.push_back(std::set<vertexUID>());
-    Coordinate<int32_t> locationCoordinate = location.getRelativeToCharger();
-    locationToVertex.emplace(locationCoordinate, vertexUid);
+    neighbours.push_back(0);
+    chargerDistances.push_back(locationCoordinate == Coordinate<int32_t>(0, 0) ? 0 : UNREACHABLE);
+    chargerParents.push_back(vertexUID(NO_VERTEX));
+    searchStamps.push_back(0);
+    searchDistances.push_back(0);
+    searchParents.push_back(vertexUID(NO_VERTEX));
+    searchQueue.push_back(vertexUID(NO_VERTEX));
+    growGrid(locationCoordinate);
+    grid[static_cast<std::size_t>(locationCoordinate.getX() - gridMinX) * gridCols + (locationCoordinate.getY() - gridMinY)] = vertexUid;
 }
 std::vector<MappingGraphEdge> MappingGraph::iGetEdges(Coordinate<int32_t> v)
 {
     std::vector<MappingGraphEdge> edges = std::vector<MappingGraphEdge>();
-    for (const vertexUID &target : adj.at(locationToVertex.at(v)))
+    vertexUID targets[4];
+    uint32_t count = getNeighbours(vertexAt(v), targets);
+    for (uint32_t i = 0; i < count; i++)
     {
-        edges.push_back(MappingGraphEdge(v, locations[target].getRelativeToCharger()));
+        edges.push_back(MappingGraphEdge(v, locations[targets[i]].getRelativeToCharger()));
     }
     return edges;
 }
 
 bool MappingGraph::isVertex(Coordinate<int32_t> location) const
 {
-    for (auto const &pair : locationToVertex)
+    return findVertex(location) != NO_VERTEX;
+}
+bool MappingGraph::isEdge(Coordinate<int32_t> v, Direction direction) const
+{
+    vertexUID start = findVertex(v);
+    if (start == NO_VERTEX || findVertex(v.getDirection(direction)) == NO_VERTEX)
     {
-        if (pair.first == location)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    return neighbours[start] & directionBit(direction);
 }
-std::unordered_map<Coordinate<int32_t>, BFSResult>::const_iterator MappingGraph::bfsInternal(vertexUID start, std::unordered_map<Coordinate<int32_t>, BFSResult> &outMap, std::optional<std::function<bool(const Coordinate<int32_t> &, const BFSResult &)>> predicate = std::nullopt) const
+/**
+ * Every predicate is asked about every vertex in BFS order until it matched once.
+ * A predicate must not start another search on this graph, it would overwrite the workspace this one is using
+ */
+BFSView MappingGraph::bfsInternal(vertexUID start, std::span<const BFSPredicate> predicates, bool untilFirstMatches) const
 {
-    std::vector<BFSNode> nodes;
-    for (uint32_t i = 0; i < size(); i++)
+    if (predicates.size() > MAX_BFS_QUERIES)
     {
-        nodes.push_back(BFSNode(i));
-        if (i == start)
+        throw std::invalid_argument("Too many predicates for one BFS");
+    }
+    if (searching)
+    {
+        throw std::logic_error("BFS started from inside a BFS predicate");
+    }
+    searching = true;
+    struct SearchGuard
+    {
+        bool &searching;
+        ~SearchGuard() { searching = false; }
+    } guard{searching};
+    if (++searchEpoch == 0)
+    {
+        std::fill(searchStamps.begin(), searchStamps.end(), 0);
+        searchEpoch = 1;
+    }
+    std::array<vertexUID, MAX_BFS_QUERIES> found;
+    found.fill(vertexUID(NO_VERTEX));
+    std::size_t unmatched = predicates.size();
+    /*
+        Returns true once the traversal can stop
+    */
+    auto visit = [&](vertexUID vertex, const BFSResult &result)
+    {
+        for (std::size_t query = 0; query < predicates.size(); query++)
         {
-            nodes.at(start).setDistance(0);
-            nodes.at(start).setColor(BFSNode::Color::GRAY);
-            auto [coordinate, bfsResult] = getBFSResult(nodes.at(start));
-            auto result = outMap.emplace(coordinate, bfsResult);
-            if (predicate.has_value())
+            if (found[query] == NO_VERTEX && predicates[query](locations[vertex].getRelativeToCharger(), result))
             {
-                if (predicate.value()(coordinate, bfsResult))
-                {
-                    return result.first;
-                }
+                found[query] = vertex;
+                unmatched--;
             }
         }
-    }
-    std::queue<vertexUID> queue;
-    queue.push(start);
-    while (!queue.empty())
+        return !predicates.empty() && (unmatched == 0 || (untilFirstMatches && found[0] != NO_VERTEX));
+    };
+    searchStamps[start] = searchEpoch;
+    searchDistances[start] = 0;
+    searchParents[start] = NO_VERTEX;
+    bool done = visit(start, BFSResult(0, std::nullopt));
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    searchQueue[tail++] = start;
+    while (!done && head < tail)
     {
-        vertexUID u = queue.front();
-        queue.pop();
-        BFSNode &unode = nodes.at(u);
-        for (const vertexUID &target : adj.at(u))
+        vertexUID u = searchQueue[head++];
+        vertexUID targets[4];
+        uint32_t targetCount = getNeighbours(u, targets);
+        for (uint32_t i = 0; i < targetCount && !done; i++)
         {
-            BFSNode &wnode = nodes.at(target);
-
-            if (wnode.getColor() == BFSNode::Color::WHITE)
+            vertexUID target = targets[i];
+            if (isReached(target))
             {
-                wnode.setColor(BFSNode::Color::GRAY);
-                wnode.setDistance(unode.getDistance() + 1);
-                wnode.setParent(u);
-                queue.push(target);
-
-                auto [coordinate, bfsResult] = getBFSResult(wnode);
-                auto result = outMap.emplace(coordinate, bfsResult);
-                if (predicate.has_value())
-                {
-                    if (predicate.value()(coordinate, bfsResult))
-                    {
-                        return result.first;
-                    }
-                }
+                continue;
             }
+            searchStamps[target] = searchEpoch;
+            searchDistances[target] = searchDistances[u] + 1;
+            searchParents[target] = u;
+            searchQueue[tail++] = target;
+            done = visit(target, BFSResult(searchDistances[target], locations[u].getRelativeToCharger()));
         }
-        unode.setColor(BFSNode::Color::BLACK);
     }
-    return outMap.cend();
+    return BFSView(*this, searchEpoch, found);
+}
+BFSView MappingGraph::bfs_find_first(Coordinate<int32_t> startCoordinate, const BFSPredicate &predicate) const
+{
+    return bfsInternal(vertexAt(startCoordinate), std::span<const BFSPredicate>(&predicate, 1), true);
+}
+BFSView MappingGraph::bfs_find_each(Coordinate<int32_t> startCoordinate, std::span<const BFSPredicate> predicates) const
+{
+    return bfsInternal(vertexAt(startCoordinate), predicates, false);
+}
+BFSView MappingGraph::bfs_find_first_of(Coordinate<int32_t> startCoordinate, std::span<const BFSPredicate> predicates) const
+{
+    return bfsInternal(vertexAt(startCoordinate), predicates, true);
+}
+BFSView MappingGraph::bfs(Coordinate<int32_t> startCoordinate) const
+{
+    return bfsInternal(vertexAt(startCoordinate), {}, false);
 }
-std::pair<Coordinate<int32_t>, BFSResult> MappingGraph::getBFSResult(const BFSNode &node) const
+vertexUID BFSView::reachedVertex(Coordinate<int32_t> location) const
 {
-    std::optional<Coordinate<int32_t>> parent = std::nullopt;
-    if (node.getParent() != NO_VERTEX)
+    if (graph->searchEpoch != epoch)
     {
-        parent = locations.at(node.getParent()).getRelativeToCharger();
+        throw std::logic_error("BFS view read after another search on the graph");
     }
-    auto result = BFSResult(
-        node.getDistance(),
-        parent);
-    auto coordinate = locations.at(node.getVertex()).getRelativeToCharger();
-    return std::pair<Coordinate<int32_t>, BFSResult>(coordinate, result);
+    vertexUID vertex = graph->findVertex(location);
+    if (vertex == MappingGraph::NO_VERTEX || !graph->isReached(vertex))
+    {
+        return MappingGraph::NO_VERTEX;
+    }
+    return vertex;
 }
-std::pair<std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>>, std::unordered_map<Coordinate<int32_t>, BFSResult>::const_iterator> MappingGraph::bfs_find_first(Coordinate<int32_t> startCoordinate, std::function<bool(const Coordinate<int32_t> &, const BFSResult &)> predicate) const
+Coordinate<int32_t> BFSView::getFound(std::size_t query) const
 {
-    vertexUID start = locationToVertex.at(startCoordinate);
-    auto bfsResults = std::make_shared<std::unordered_map<Coordinate<int32_t>, BFSResult>>();
-    auto iterator = bfsInternal(start, *bfsResults, predicate);
-    if (iterator == bfsResults->cend())
+    if (!isFound(query))
     {
-        return std::make_pair(bfsResults, iterator);
+        throw std::logic_error("BFS found no matching vertex");
     }
-    return std::make_pair(bfsResults, iterator);
+    return graph->locations[found[query]].getRelativeToCharger();
+}
+bool BFSView::contains(Coordinate<int32_t> location) const
+{
+    return reachedVertex(location) != MappingGraph::NO_VERTEX;
 }
-std::shared_ptr<std::unordered_map<Coordinate<int32_t>, BFSResult>> MappingGraph::bfs(Coordinate<int32_t> startCoordinate) const
+uint32_t BFSView::getDistance(Coordinate<int32_t> location) const
 {
-    if (cache.find(startCoordinate) != cache.end())
+    vertexUID vertex = reachedVertex(location);
+    if (vertex == MappingGraph::NO_VERTEX)
     {
-        return cache.at(startCoordinate);
+        throw std::out_of_range("Location was not reached by the BFS");
     }
-    vertexUID start = locationToVertex.at(startCoordinate);
-    auto bfsResults = std::make_shared<std::unordered_map<Coordinate<int32_t>, BFSResult>>();
-    bfsInternal(start, *bfsResults);
-    assert(bfsResults->size() == size());
-    cache.emplace(startCoordinate, bfsResults);
-    return bfsResults;
-}
\ No newline at end of file
+    return graph->searchDistances[vertex];
+}
+std::optional<Coordinate<int32_t>> BFSView::getParent(Coordinate<int32_t> location) const
+{
+    vertexUID vertex = reachedVertex(location);
+    if (vertex == MappingGraph::NO_VERTEX)
+    {
+        throw std::out_of_range("Location was not reached by the BFS");
+    }
+    vertexUID parent = graph->searchParents[vertex];
+    if (parent == MappingGraph::NO_VERTEX)
+    {
+        return std::nullopt;
+    }
+    return graph->locations[parent].getRelativeToCharger();
+}
@@ -0,0 +1,18 @@
+#ifndef CHARGING_ALGORITHM_H_
+#define CHARGING_ALGORITHM_H_
+
+#include <cstddef>
+
+/**
+ * Optional extension of AbstractAlgorithm for algorithms that know ahead of time how long they will keep charging.
+ * After nextStep returned Stay on the charging station, the simulator asks how many more Stay steps the algorithm
+ * would return in a row and applies them all at once instead of calling nextStep for each of them.
+ */
+class ChargingAlgorithm {
+public:
+	virtual ~ChargingAlgorithm() {}
+	/* The algorithm counts the returned number of Stay steps, at most maxChargeSteps, as already taken */
+	virtual std::size_t takeChargeSteps(std::size_t maxChargeSteps) = 0;
+};
+
+#endif  // CHARGING_ALGORITHM_H_
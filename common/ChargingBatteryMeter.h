@@ -0,0 +1,23 @@
+#ifndef CHARGING_BATTERY_METER_H_
+#define CHARGING_BATTERY_METER_H_
+
+#include <cstddef>
+#include <optional>
+
+#include "BatteryMeter.h"
+
+/**
+ * A battery meter that can also answer charging questions without simulating the charge step by step.
+ * Each step on the charging station charges 1/20 of the maximal battery.
+ */
+class ChargingBatteryMeter : public BatteryMeter {
+public:
+	virtual ~ChargingBatteryMeter() {}
+	virtual std::size_t getMaxBatteryState() const = 0;
+	/* The battery state after staying on the charging station for the given number of steps */
+	virtual std::size_t getBatteryStateAfterCharging(std::size_t chargeSteps) const = 0;
+	/* The number of steps to stay on the charging station until the battery state reaches the target, nullopt if it never will */
+	virtual std::optional<std::size_t> getChargeStepsToReach(std::size_t batteryState) const = 0;
+};
+
+#endif  // CHARGING_BATTERY_METER_H_
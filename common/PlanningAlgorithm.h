@@ -0,0 +1,22 @@
+#ifndef PLANNING_ALGORITHM_H_
+#define PLANNING_ALGORITHM_H_
+
+#include <vector>
+
+#include "enums.h"
+
+/**
+ * Optional extension of AbstractAlgorithm for algorithms that plan a whole path at once.
+ * nextSteps replaces nextStep and returns the chosen step followed by the rest of the planned path, if any.
+ * Before applying each following step the simulator calls continuePlan, which reads the sensors again and
+ * returns false when what they report no longer matches the plan. The rest of the plan is then dropped and
+ * the simulator asks for new steps.
+ */
+class PlanningAlgorithm {
+public:
+	virtual ~PlanningAlgorithm() {}
+	virtual std::vector<Step> nextSteps() = 0;
+	virtual bool continuePlan() = 0;
+};
+
+#endif  // PLANNING_ALGORITHM_H_
@@ -0,0 +1,38 @@
+#ifndef SENSOR_SNAPSHOT_H_
+#define SENSOR_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "enums.h"
+
+/**
+ * Everything the sensors report about the current step, bit d of wallMask is set when isWall(Direction(d)) is true
+ */
+struct SensorReadings {
+	std::uint8_t wallMask = 0;
+	int dirtLevel = 0;
+	std::size_t batteryState = 0;
+	bool isWall(Direction d) const { return wallMask & (1 << static_cast<std::uint8_t>(d)); }
+};
+
+/**
+ * Optional sensor that reads the walls, dirt and battery in a single call instead of one call per sensor query
+ */
+class SensorSnapshot {
+public:
+	virtual ~SensorSnapshot() {}
+	virtual SensorReadings getSensorReadings() const = 0;
+};
+
+/**
+ * Optional extension of AbstractAlgorithm for algorithms that can read their sensors through a SensorSnapshot.
+ * The classic sensors are still set, the snapshot is only given in addition to them.
+ */
+class SensorSnapshotAlgorithm {
+public:
+	virtual ~SensorSnapshotAlgorithm() {}
+	virtual void setSensorSnapshot(const SensorSnapshot &) = 0;
+};
+
+#endif  // SENSOR_SNAPSHOT_H_
@@ -2,6 +2,7 @@
 #include "AbstractAlgorithm.h"
 #include "AlgorithmRegistrar.h"
 #include "VacuumSimulator.hpp"
+#include "VacuumParser.hpp"
 #include <dlfcn.h>
 #include <iostream>
 #include <memory>
@@ -9,26 +10,13 @@
 #include <string>
 #include <thread>
 #include <mutex>
-#include <future>
 #include <filesystem>
 #include <chrono>
 #include <fstream>
 #include <stdexcept>
-#include <boost/asio.hpp>
-#include <boost/bind/bind.hpp>
-#include <dlfcn.h>
+#include <sstream>
+#include <algorithm>
 
-class factoryException : public std::exception
-{
-    public:
-        factoryException(const std::string& message) : message(message) {}
-        const char* what() const noexcept override
-        {
-            return message.c_str();
-        }
-    private:
-        std::string message;
-};
 void writeErrorFile(const std::filesystem::path& houseFile,const std::string& algorithmName, const std::string& errorMessage);
 void writeErrorFile(const std::string& algorithmName, const std::string& errorMessage);
 std::filesystem::path getErrorPathFile(const std::filesystem::path& houseFile, const std::string& algorithmName ) {
@@ -47,13 +35,18 @@ std::filesystem::path getErrorPathFile(const std::filesystem::path& houseFile, c
     }
     throw std::invalid_argument("Could not create error file");
 }
-void writeErrorFile(const std::filesystem::path& houseFile,const std::string& algorithmName, const std::string& errorMessage) {
-
+std::filesystem::path getCheckedErrorPathFile(const std::filesystem::path& houseFile, const std::string& algorithmName)
+{
     auto path = getErrorPathFile(houseFile, algorithmName);
     if (!(path.has_filename() && path.has_extension() && std::filesystem::exists(path.parent_path())))
     {
         throw std::invalid_argument("Could not create error file");
     }
+    return path;
+}
+void writeErrorFile(const std::filesystem::path& houseFile,const std::string& algorithmName, const std::string& errorMessage) {
+
+    auto path = getCheckedErrorPathFile(houseFile, algorithmName);
     std::ofstream errorFile(path);
     if (!errorFile.is_open())
     {
@@ -70,86 +63,103 @@ void writeErrorFile(const std::filesystem::path& houseFile, const std::string& e
 {
     writeErrorFile(houseFile,"",errorMessage);
 }
+/**
+ * Error files of simulations go through the output thread as well, the path is still checked on the calling thread
+ */
+void writeErrorFile(OutputWriter &output, const std::filesystem::path& houseFile, const std::string& errorMessage)
+{
+    auto path = getCheckedErrorPathFile(houseFile, "");
+    output.write(path, [errorMessage](std::ostream &errorFile) { errorFile << errorMessage << std::endl; });
+}
+OutputWriter::ErrorHandler reportOutputError(OutputWriter &output, const std::filesystem::path& houseFile)
+{
+    return [&output, houseFile](const std::string &what) {
+        writeErrorFile(output, houseFile, "Error: Unable to write output file: " + houseFile.stem().string() + what);
+    };
+}
 
-void runSimulation(const std::string name, std::unique_ptr<AbstractAlgorithm> algorithm, const std::filesystem::path& houseFile,const SimulationArguments& args,std::mutex &summaryMutex, std::shared_ptr<std::counting_semaphore<>> semaphore)
+void runSimulation(const std::string name, std::unique_ptr<AbstractAlgorithm> algorithm, const std::filesystem::path& houseFile,const SimulationArguments& args, SimulationContext &context)
 {
+    auto &output = context.output;
     VacuumSimulator simulator;
-    boost::asio::io_context context;
     try
     {
-        simulator.readHouseFile(houseFile);
+        simulator.setHouse(houseFile, context.houseCache.acquire(houseFile));
     }
     catch(const std::exception& e)
     {
         std::string errorMessage = "Error: Unable to read House file: " + houseFile.stem().string() + e.what();
-        writeErrorFile(houseFile, errorMessage);
-        semaphore->release();
+        writeErrorFile(output, houseFile, errorMessage);
         return;
     }
-    auto maxTime = simulator.getMaxTime();
-    boost::asio::steady_timer timer(context, maxTime);
-    std::atomic<bool> isTimedOut = false;
-    std::atomic<bool> error = false;
-    std::string errorMessage;
-    std::future<void> simFuture = std::async(std::launch::async, [&]() {
-        try {
-            simulator.setAlgorithm(std::move(algorithm));
-            simulator.run();
-            context.stop();
-            return;
-        }
-        catch (const std::invalid_argument& e) {
-            errorMessage = "Error: Unable to parse House file: " + houseFile.stem().string() + e.what();
-            error = true;
-        }
-        catch (const std::exception& e) {
-            errorMessage = "Error: Simulator Error " + houseFile.stem().string() + e.what();
-            error = true;
-        }
-        if(!isTimedOut)
+    simulator.setKeepHistory(!args.isSummaryOnly());
+    if (args.isStreamOutput() && !args.isSummaryOnly())
+    {
+        try
         {
-            context.stop();
-            writeErrorFile(houseFile, errorMessage);
+            simulator.streamRecord(name);
         }
-    });
-
-    timer.async_wait([&](const boost::system::error_code& ec) {
-        if (!ec) {
-            if (simFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-                simulator.timeout();
-                isTimedOut = true;
-            }
-            context.stop();
+        catch(const std::exception& e)
+        {
+            std::string errorMessage = "Error: Unable to write output file: " + houseFile.stem().string() + e.what();
+            writeErrorFile(output, houseFile, errorMessage);
+            return;
         }
-    });
-
-    context.run();
-
-    if (!isTimedOut && simFuture.valid())
+    }
+    /*
+        The simulation runs on this thread, the watchdog only flags it as timed out and the simulator stops at its next step.
+        With cpu_time the limit is on the CPU time of this thread, which is where the algorithm runs
+    */
+    Watchdog::DeadlineId deadline;
+    if (args.isCpuTime())
+    {
+        deadline = context.watchdog.armCpuTime(simulator.getMaxTime(), simulator.getMaxTime() * BatchVacuumSimulator::WALL_TIME_BACKSTOP, [&simulator]() { simulator.timeout(); });
+    }
+    else
     {
-        simFuture.get(); 
+        deadline = context.watchdog.arm(Watchdog::Clock::now() + simulator.getMaxTime(), [&simulator]() { simulator.timeout(); });
     }
-    
+    if (context.onStart)
+    {
+        context.onStart(name, simulator);
+    }
+    bool error = false;
+    std::string errorMessage;
+    try {
+        simulator.setAlgorithm(std::move(algorithm));
+        simulator.run();
+    }
+    catch (const std::invalid_argument& e) {
+        errorMessage = "Error: Unable to parse House file: " + houseFile.stem().string() + e.what();
+        error = true;
+    }
+    catch (const std::exception& e) {
+        errorMessage = "Error: Simulator Error " + houseFile.stem().string() + e.what();
+        error = true;
+    }
+    context.watchdog.disarm(deadline);
+    if (context.onStop)
+    {
+        context.onStop(simulator);
+    }
+    if (error && !simulator.isTimedOut())
+    {
+        writeErrorFile(output, houseFile, errorMessage);
+    }
+
     try
     {
-        std::lock_guard<std::mutex> lock(summaryMutex);
-        if (!error)
+        if (!error && !args.isSummaryOnly())
         {
-            if (!args.isSummaryOnly())
-            {
-                simulator.exportRecord(name);
-            }
+            simulator.exportRecord(name, output, reportOutputError(output, houseFile));
         }
-        simulator.exportSummary(name,error);
+        context.reportScore(name, simulator.getHouseName(), simulator.getScore(error));
     } 
     catch (const std::exception& e)
     {
         std::string errorMessage = "Error: Unable to write output file: " + houseFile.stem().string() + e.what();
-        writeErrorFile(houseFile, errorMessage);
+        writeErrorFile(output, houseFile, errorMessage);
     }
-    
-    
-    semaphore->release();
 }
 
 
@@ -195,7 +205,8 @@ BatchVacuumSimulator::~BatchVacuumSimulator()
     clearHandles();
 }
 
-void BatchVacuumSimulator::enqueueTask(const SimulationArguments &args, const std::filesystem::path &houseFile, auto &algorithm) {
+void BatchVacuumSimulator::runTask(const SimulationArguments &args, const std::filesystem::path &houseFile, const auto &algorithm, SimulationContext &context)
+{
     std::unique_ptr<AbstractAlgorithm> algorithmInstance = nullptr;
     std::string name;
     try{
@@ -203,56 +214,191 @@ void BatchVacuumSimulator::enqueueTask(const SimulationArguments &args, const st
         algorithmInstance = algorithm.create();
     }catch(const std::exception& e)
     {
-        throw factoryException("Error: Algorithm supplied is invalid factory of name cannot be resolved " + name + e.what());
+        writeErrorFile(context.output, houseFile, "Error: Algorithm supplied is invalid factory of name cannot be resolved " + name + e.what());
+        // The run never gets to acquire the house, its use is given up so the house still leaves the cache
+        context.houseCache.release(houseFile);
+        return;
     }
-    threadPool.emplace_back(runSimulation, name, std::move(algorithmInstance),
-                    houseFile, std::ref(args),std::ref(summaryMutex), semaphore);
+    runSimulation(name, std::move(algorithmInstance), houseFile, args, context);
 }
-void BatchVacuumSimulator::discardFinishedThreads()
+
+void BatchVacuumSimulator::enqueueTask(const SimulationArguments &args) {
+    /*
+        Which run a job does is only decided once a worker picks it up, so the next house is the longest one left by what was learned so far
+    */
+    pool->submit([this, &args]() {
+        auto task = scheduler->next();
+        if (!task)
+        {
+            return;
+        }
+        auto &algorithms = AlgorithmRegistrar::getAlgorithmRegistrar();
+        std::size_t steps = 0;
+        SimulationContext context{*output, *houseCache, *watchdog, [this](const std::string &algorithmName, const std::string &houseName, std::optional<uint32_t> score) {
+            summary->set(algorithmName, houseName, score);
+        }, nullptr, [&steps](const VacuumSimulator &simulator) { steps = simulator.getStepsTaken(); }};
+        MemoryBudget::Reservation reservation;
+        if (memoryBudget)
+        {
+            bool keepHistory = !args.isSummaryOnly() && !args.isStreamOutput();
+            reservation = memoryBudget->reserve(task->header ? MemoryBudget::estimate(*task->header, keepHistory) : 0);
+        }
+        auto start = TaskScheduler::Clock::now();
+        runTask(args, task->houseFile, *(algorithms.begin() + task->algorithm), context);
+        scheduler->finished(*task, TaskScheduler::Clock::now() - start, steps);
+    });
+}
+
+std::string encodeScore(const std::string &algorithmName, const std::string &houseName, std::optional<uint32_t> score)
+{
+    return algorithmName + "\n" + houseName + "\n" + (score ? std::to_string(*score) : "");
+}
+void decodeScore(const std::string &encoded, SummaryTable &summary, bool dropScore)
 {
-    threadPool.erase(std::remove_if(threadPool.begin(), threadPool.end(), [](std::thread &thread) {
-        if (thread.joinable())
+    std::istringstream lines(encoded);
+    std::string algorithmName, houseName, score;
+    if (!std::getline(lines, algorithmName) || !std::getline(lines, houseName))
+    {
+        return;
+    }
+    std::getline(lines, score);
+    summary.set(algorithmName, houseName, (score.empty() || dropScore) ? std::nullopt : std::optional<uint32_t>(std::stoul(score)));
+}
+
+/**
+ * What a worker process keeps from one run to the next
+ */
+class WorkerState
+{
+    public:
+        OutputWriter output;
+        Watchdog watchdog;
+        std::filesystem::path houseFile;
+        std::unique_ptr<HouseCache> houseCache;
+};
+
+/**
+ * Every simulation runs in one of a fixed set of worker processes, each reporting its score back to this process.
+ * A worker keeps its own soft timeout so timed out runs come out as in the threaded batch, a worker that is still stuck
+ * in the algorithm HARD_TIMEOUT_GRACE after the soft timeout could last have fired is killed and the run is scored
+ * as timed out without an out file
+ */
+void BatchVacuumSimulator::runIsolated(const SimulationArguments &args)
+{
+    auto &algorithms = AlgorithmRegistrar::getAlgorithmRegistrar();
+    // Workers take runs in index order, so the order is fixed up front from the house headers alone
+    std::vector<std::pair<std::filesystem::path, std::size_t>> tasks;
+    // The runs of a house come out together, a worker keeps to one house while it has runs left
+    std::vector<std::size_t> houseIndex;
+    while (auto task = scheduler->next())
+    {
+        if (!tasks.empty() && tasks.back().first != task->houseFile)
         {
-            return false;
+            houseIndex.push_back(houseIndex.back() + 1);
         }
-        return true;
-    }), threadPool.end());
-    
+        else
+        {
+            houseIndex.push_back(houseIndex.empty() ? 0 : houseIndex.back());
+        }
+        tasks.emplace_back(task->houseFile, task->algorithm);
+    }
+    /*
+        Only ever made in a worker, on its first run, so its threads are started after the fork. Each worker process has its
+        own copy and keeps it for all the runs it does, the parsed house is kept while the worker stays on it
+    */
+    std::unique_ptr<WorkerState> worker;
+    ProcessPool workers(std::min<std::size_t>(args.getNumThreads(), tasks.size()), [&](std::size_t task, const ProcessPool::TaskControl &control) {
+        std::string result;
+        if (!worker)
+        {
+            worker = std::make_unique<WorkerState>();
+        }
+        if (worker->houseFile != tasks[task].first)
+        {
+            worker->houseCache = std::make_unique<HouseCache>(algorithms.count());
+            worker->houseFile = tasks[task].first;
+        }
+        SimulationContext context{worker->output, *worker->houseCache, worker->watchdog,
+            [&result](const std::string &algorithmName, const std::string &houseName, std::optional<uint32_t> score) {
+                result = encodeScore(algorithmName, houseName, score);
+            },
+            [&control, &args](const std::string &algorithmName, const VacuumSimulator &simulator) {
+                auto limit = simulator.getMaxTime() * (args.isCpuTime() ? WALL_TIME_BACKSTOP : 1) + HARD_TIMEOUT_GRACE;
+                control.setTimeLimit(limit, encodeScore(algorithmName, simulator.getHouseName(), simulator.getTimeoutScore()));
+            },
+            [&control](const VacuumSimulator &) { control.clearTimeLimit(); }};
+        runTask(args, tasks[task].first, *(algorithms.begin() + tasks[task].second), context);
+        worker->output.flush();
+        return result;
+    });
+    workers.run(tasks.size(), [&](std::size_t task, ProcessPool::Outcome outcome, const std::string &result) {
+        if (outcome == ProcessPool::Outcome::Crashed)
+        {
+            const auto &houseFile = tasks[task].first;
+            writeErrorFile(houseFile, "Error: Simulator Error " + houseFile.stem().string() + " worker process exited during the simulation");
+        }
+        decodeScore(result, *summary, outcome == ProcessPool::Outcome::Crashed);
+    }, [&](std::size_t task) { return houseIndex[task]; });
 }
 
 void BatchVacuumSimulator::run(const SimulationArguments &args) {
     reserveHandles(args.getAlgorithmFiles());
-    auto numThreads = args.getNumThreads();
     auto &algorithms = AlgorithmRegistrar::getAlgorithmRegistrar();
     auto houseFiles = args.getHouseFiles();
-    semaphore = std::make_shared<std::counting_semaphore<>>(numThreads);
-    auto algorithm = algorithms.begin();
-    auto houseFile = houseFiles.begin();
-    auto houseFileBegin = houseFiles.begin();
-    
-    while (algorithm != algorithms.end() && houseFile != houseFiles.end()) {
-        semaphore->acquire();
-        discardFinishedThreads();
-        try{
-            enqueueTask(args, *houseFile, *algorithm);
-        }
-        catch(const factoryException& e)
+    summary = std::make_unique<SummaryTable>(CWD / "summary.csv");
+    // More workers than cores do not finish any sooner
+    auto parallelism = std::min<std::size_t>(args.getNumThreads(), std::max(std::thread::hardware_concurrency(), 1u));
+    scheduler = std::make_unique<TaskScheduler>(algorithms.count(), parallelism);
+    for (const auto &houseFile : houseFiles)
+    {
+        scheduler->add(houseFile, VacuumParser().parseHeader(houseFile));
+    }
+    auto predictedMakespan = scheduler->start();
+    auto batchStart = TaskScheduler::Clock::now();
+    if (args.isIsolated())
+    {
+        runIsolated(args);
+    }
+    else
+    {
+        houseCache = std::make_unique<HouseCache>(algorithms.count());
+        watchdog = std::make_unique<Watchdog>();
+        pool = std::make_unique<WorkStealingPool>(args.getNumThreads());
+        output = std::make_unique<OutputWriter>();
+        if (args.getMemoryBudget() > 0)
         {
-            writeErrorFile(*houseFile, e.what());
-            algorithm++;
-
+            memoryBudget = std::make_unique<MemoryBudget>(args.getMemoryBudget());
         }
-        if (++houseFile == houseFiles.end()) {
-            houseFile = houseFileBegin;
-            ++algorithm;
+        /*
+            The scheduler hands out all the algorithms of a house together so the house leaves the cache as soon as possible
+        */
+        for (std::size_t i = 0; i < houseFiles.size() * algorithms.count(); i++)
+        {
+            enqueueTask(args);
         }
+        pool.reset();
+        watchdog.reset();
+        output.reset();
+        memoryBudget.reset();
     }
-    for (auto &thread: threadPool) {
-        if (thread.joinable()) {
-            thread.join();
+    auto actualMakespan = TaskScheduler::Clock::now() - batchStart;
+    std::cout << "Makespan: predicted " << std::chrono::duration_cast<std::chrono::milliseconds>(predictedMakespan).count() << "ms, actual "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(actualMakespan).count() << "ms" << std::endl;
+    scheduler.reset();
+    /*
+        Every score is in memory by now, summary.csv is written once for the whole batch
+    */
+    if (summary->isChanged())
+    {
+        try
+        {
+            summary->write();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: Unable to write summary file " << e.what() << std::endl;
         }
     }
-    threadPool.clear();
     AlgorithmRegistrar::getAlgorithmRegistrar().clear();
     clearHandles();
-}
\ No newline at end of file
+}
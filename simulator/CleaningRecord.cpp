@@ -1,9 +1,17 @@
 #include "CleaningRecord.hpp"
+#include "Step.hpp"
+#include <algorithm>
 
-CleaningRecord::CleaningRecord(const CleaningRecordStep& initialStep, uint32_t maxSteps)
-    : hasInitialStep(true), maxSteps(maxSteps) {
-    steps = std::vector<std::shared_ptr<CleaningRecordStep>>();
-    steps.emplace_back(std::make_shared<CleaningRecordStep>(initialStep));
+CleaningRecord::CleaningRecord(const CleaningRecordStep& initialStep, uint32_t maxSteps, bool keepHistory)
+    : hasInitialStep(true), maxSteps(maxSteps), keepHistory(keepHistory), initialDirt(initialStep.getDirtLevel()) {
+    if (keepHistory) {
+        // One extra slot for the Finish step
+        auto reservedSteps = std::min<std::size_t>(static_cast<std::size_t>(maxSteps) + 1, MAX_RESERVED_STEPS);
+        moves.reserve(reservedSteps);
+        batteryLevels.reserve(reservedSteps);
+        dirtLevels.reserve(reservedSteps);
+    }
+    push(initialStep);
 }
 Status CleaningRecord::getStatus() const
 {
@@ -17,33 +25,121 @@ Status CleaningRecord::getStatus() const
     }
     return Status::WORKING;
 }
-const std::shared_ptr<CleaningRecordStep> CleaningRecord::operator[](std::size_t idx) {
-    return steps.at(idx);
+uint8_t CleaningRecord::pack(LocationType locationType, Step step) {
+    uint8_t locationBits = 0;
+    switch (locationType) {
+        case LocationType::WALL: locationBits = 0; break;
+        case LocationType::CHARGING_STATION: locationBits = 1; break;
+        case LocationType::HOUSE_TILE: locationBits = 2; break;
+        case LocationType::UNKNOWN: locationBits = 3; break;
+    }
+    return static_cast<uint8_t>(locationBits << LOCATION_TYPE_SHIFT) | static_cast<uint8_t>(step);
+}
+LocationType CleaningRecord::unpackLocationType(uint8_t move) {
+    switch (move >> LOCATION_TYPE_SHIFT) {
+        case 0: return LocationType::WALL;
+        case 1: return LocationType::CHARGING_STATION;
+        case 2: return LocationType::HOUSE_TILE;
+        default: return LocationType::UNKNOWN;
+    }
+}
+CleaningRecordStep CleaningRecord::operator[](std::size_t idx) const {
+    if (!keepHistory && !hasInitialStep) {
+        if (idx != recordedSteps - 1) {
+            throw std::out_of_range("Step history is not kept, only the last step is available");
+        }
+        idx = 0;
+    }
+    return getStoredStep(idx);
+}
+CleaningRecordStep CleaningRecord::getStoredStep(std::size_t idx) const {
+    std::size_t entry = idx;
+    auto run = std::upper_bound(chargingRuns.begin(), chargingRuns.end(), idx, [](std::size_t step, const ChargingRun& chargingRun) {
+        return step < chargingRun.firstStep;
+    });
+    if (run != chargingRuns.begin()) {
+        --run;
+        std::size_t stepInRun = idx - run->firstStep;
+        if (stepInRun < run->count) {
+            uint8_t move = moves.at(run->entry);
+            return CleaningRecordStep(unpackLocationType(move), unpackStep(move), run->batteryBefore.getBatteryStateAfterCharging(stepInRun + 1), dirtLevels[run->entry]);
+        }
+        entry = run->entry + 1 + (stepInRun - run->count);
+    }
+    return getEntry(entry);
+}
+CleaningRecordStep CleaningRecord::getEntry(std::size_t entry) const {
+    uint8_t move = moves.at(entry);
+    return CleaningRecordStep(unpackLocationType(move), unpackStep(move), batteryLevels[entry], dirtLevels[entry]);
 }
 
-const std::shared_ptr<CleaningRecordStep> CleaningRecord::last() const {
-    return steps.back();
+CleaningRecordStep CleaningRecord::last() const {
+    return getEntry(moves.size() - 1);
 }
 
-void CleaningRecord::add(CleaningRecordStep step) {
+void CleaningRecord::push(const CleaningRecordStep& step) {
+    if (!keepHistory && !moves.empty()) {
+        // Overwrite in place so the last step stays readable while the run is still going
+        moves[0] = pack(step.getLocationType(), step.getStep());
+        batteryLevels[0] = step.getBatteryLevel();
+        dirtLevels[0] = step.getDirtLevel();
+        return;
+    }
+    moves.push_back(pack(step.getLocationType(), step.getStep()));
+    batteryLevels.push_back(step.getBatteryLevel());
+    dirtLevels.push_back(step.getDirtLevel());
+}
+void CleaningRecord::clear() {
+    moves.clear();
+    batteryLevels.clear();
+    dirtLevels.clear();
+    chargingRuns.clear();
+}
+void CleaningRecord::startStep() {
     if (hasInitialStep) {
-        steps.clear();
+        if (keepHistory) {
+            clear();
+        }
         hasInitialStep = false;
     }
-    steps.emplace_back(std::make_shared<CleaningRecordStep>(step));
 }
 
-const std::shared_ptr<CleaningRecordStep> CleaningRecord::getInitialStep() const {
+void CleaningRecord::add(const CleaningRecordStep& step) {
+    startStep();
+    push(step);
+    recordedSteps++;
+}
+void CleaningRecord::addCharging(const CleaningRecordStep& lastStep, uint32_t count, const MeteredVacuumBattery& batteryBefore) {
+    if (count == 0) {
+        return;
+    }
+    startStep();
+    if (keepHistory) {
+        chargingRuns.push_back(ChargingRun{recordedSteps, moves.size(), count, batteryBefore});
+    }
+    push(lastStep);
+    recordedSteps += count;
+}
+
+std::optional<CleaningRecordStep> CleaningRecord::getInitialStep() const {
     if (hasInitialStep) {
-        return steps[0];
+        return (*this)[0];
     }
-    return nullptr;
+    return std::nullopt;
 }
 
 std::ostream& operator<<(std::ostream& os, const CleaningRecord& record) {
-    if (!record.hasInitialStep) {
-        for (const auto& step : record.steps) {
-            os << *step;
+    if (!record.hasInitialStep && record.keepHistory) {
+        auto run = record.chargingRuns.begin();
+        for (std::size_t entry = 0; entry < record.moves.size(); entry++) {
+            uint32_t count = 1;
+            if (run != record.chargingRuns.end() && run->entry == entry) {
+                count = run->count;
+                ++run;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                os << CleaningRecord::unpackStep(record.moves[entry]);
+            }
         }
     }
     return os;
@@ -54,14 +150,11 @@ uint32_t CleaningRecord::size() const {
         return 0;
     }
     
-    if (last()->getStep() == Step::Finish) {
-        return steps.size() - 1;
+    if (unpackStep(moves.back()) == Step::Finish) {
+        return recordedSteps - 1;
     }
-    return steps.size();
+    return recordedSteps;
 }
-uint32_t CleaningRecord::getInitialDirt(){
-    if (hasInitialStep) {
-        return 0;
-    }
-    return steps[0]->getDirtLevel();
+uint32_t CleaningRecord::getInitialDirt() const{
+    return initialDirt;
 }
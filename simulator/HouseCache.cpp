@@ -0,0 +1,69 @@
+#include "HouseCache.hpp"
+#include "VacuumParser.hpp"
+#include <iostream>
+
+std::shared_ptr<const VacuumPayload> parseHouseFile(const std::filesystem::path &houseFile)
+{
+    VacuumParser parser;
+    std::shared_ptr<const VacuumPayload> payload = parser.parse(houseFile);
+    if (payload == nullptr)
+    {
+        std::cerr << "Failed to parse house file: " << houseFile << std::endl;
+        throw std::invalid_argument("Failed to parse house file");
+    }
+    return payload;
+}
+
+std::shared_ptr<const VacuumPayload> HouseCache::acquire(const std::filesystem::path &houseFile)
+{
+    std::shared_future<std::shared_ptr<const VacuumPayload>> payload;
+    std::promise<std::shared_ptr<const VacuumPayload>> parsedPayload;
+    bool shouldParse = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.try_emplace(houseFile.string(), Entry({}, usesPerHouse)).first;
+        if (!entry->second.payload.valid())
+        {
+            shouldParse = true;
+            entry->second.payload = parsedPayload.get_future().share();
+        }
+        payload = entry->second.payload;
+        useLocked(entry);
+    }
+    /*
+        Parsing happens outside the lock, other tasks asking for the same house wait on the future instead of parsing it again
+    */
+    if (shouldParse)
+    {
+        try
+        {
+            parsedPayload.set_value(parseHouseFile(houseFile));
+        }
+        catch (...)
+        {
+            parsedPayload.set_exception(std::current_exception());
+        }
+    }
+    return payload.get();
+}
+void HouseCache::release(const std::filesystem::path &houseFile)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    useLocked(entries.try_emplace(houseFile.string(), Entry({}, usesPerHouse)).first);
+}
+void HouseCache::useLocked(std::unordered_map<std::string, Entry>::iterator entry)
+{
+    if (entry->second.remainingUses <= 1)
+    {
+        entries.erase(entry);
+    }
+    else
+    {
+        entry->second.remainingUses--;
+    }
+}
+std::size_t HouseCache::size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,100 @@
+#include "MemoryBudget.hpp"
+#include <algorithm>
+#include <fstream>
+#include <unistd.h>
+
+MemoryBudget::Reservation &MemoryBudget::Reservation::operator=(Reservation &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (budget)
+        {
+            budget->release(bytes);
+        }
+        budget = std::exchange(other.budget, nullptr);
+        bytes = other.bytes;
+    }
+    return *this;
+}
+MemoryBudget::Reservation::~Reservation()
+{
+    if (budget)
+    {
+        budget->release(bytes);
+    }
+}
+MemoryBudget::MemoryBudget(std::size_t budgetBytes) : budget(budgetBytes)
+{
+}
+/**
+ * The house grid, the record of every step when history is kept and the map the algorithm builds of the house
+ */
+std::size_t MemoryBudget::estimate(const HouseHeader &header, bool keepHistory)
+{
+    std::size_t tiles = static_cast<std::size_t>(header.rows) * header.cols;
+    std::size_t steps = keepHistory ? header.maxSteps : 0;
+    return BYTES_PER_RUN + tiles * (BYTES_PER_TILE + ALGORITHM_BYTES_PER_TILE) + steps * BYTES_PER_STEP;
+}
+std::size_t MemoryBudget::readResidentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+/**
+ * Moves the scale towards what the runs in flight actually use over what they reserved. What they use is the growth of the
+ * resident size since nothing was running, so memory the batch holds between runs (parsed houses, queued output, heap the
+ * allocator keeps) is not put on them
+ */
+void MemoryBudget::measure()
+{
+    auto resident = readResidentBytes();
+    if (reserved == 0 || resident == 0)
+    {
+        return;
+    }
+    baseline = std::min(baseline, resident);
+    double observed = static_cast<double>(resident - baseline) / reserved;
+    scale = std::clamp(0.8 * scale + 0.2 * observed, MIN_SCALE, MAX_SCALE);
+}
+MemoryBudget::Reservation MemoryBudget::reserve(std::size_t estimatedBytes)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (inFlight == 0)
+    {
+        baseline = readResidentBytes();
+    }
+    measure();
+    while (inFlight > 0 && (reserved + estimatedBytes) * scale > budget)
+    {
+        released.wait_for(lock, RECHECK_INTERVAL);
+        measure();
+    }
+    reserved += estimatedBytes;
+    inFlight++;
+    return Reservation(this, estimatedBytes);
+}
+void MemoryBudget::release(std::size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reserved -= bytes;
+        inFlight--;
+    }
+    released.notify_all();
+}
+std::size_t MemoryBudget::getReservedBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return reserved;
+}
+double MemoryBudget::getScale()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return scale;
+}
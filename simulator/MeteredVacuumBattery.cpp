@@ -1,24 +1,37 @@
 #include "MeteredVacuumBattery.hpp"
-double MeteredVacuumBattery::calculateNewBatteryLevel(uint32_t steps) {
-    // Without the compensation a 0.999999999997 charge level as a result of double inherit inaccuracy would be considered as 0
-    double newBatteryLevel = this->batteryLevel + steps * ((double)maxBatterySteps / 20);
-    return newBatteryLevel;
+#include <algorithm>
+uint64_t MeteredVacuumBattery::getLevelAfterCharging(uint64_t steps) const {
+    if (maxBatterySteps == 0 || batteryLevel >= getMaxLevel()) {
+        return std::min(batteryLevel, getMaxLevel());
+    }
+    uint64_t stepsToFull = (getMaxLevel() - batteryLevel + maxBatterySteps - 1) / maxBatterySteps;
+    if (steps >= stepsToFull) {
+        return getMaxLevel();
+    }
+    return batteryLevel + steps * maxBatterySteps;
 }
 
 void MeteredVacuumBattery::charge(uint32_t steps) {
-    double newBatteryLevel = calculateNewBatteryLevel(steps);
-    this->batteryLevel = newBatteryLevel;
-    if (newBatteryLevel > maxBatterySteps) {
-        this->batteryLevel = maxBatterySteps;
-    }
+    this->batteryLevel = getLevelAfterCharging(steps);
 }
 
 bool MeteredVacuumBattery::try_activate(uint32_t steps) {
-    double newBatteryLevel = getCompensatedBatteryLevel() - steps;
-    if (newBatteryLevel < 0) {
+    uint64_t requiredLevel = static_cast<uint64_t>(steps) * CHARGE_STEPS_TO_FULL;
+    if (batteryLevel < requiredLevel) {
         this->batteryLevel = 0;
         return false;
     }
-    this->batteryLevel = newBatteryLevel;
+    this->batteryLevel -= requiredLevel;
     return true;
 }
+
+std::optional<std::size_t> MeteredVacuumBattery::getChargeStepsToReach(std::size_t batteryState) const {
+    uint64_t targetLevel = static_cast<uint64_t>(batteryState) * CHARGE_STEPS_TO_FULL;
+    if (targetLevel <= batteryLevel) {
+        return 0;
+    }
+    if (batteryState > maxBatterySteps) {
+        return std::nullopt;
+    }
+    return (targetLevel - batteryLevel + maxBatterySteps - 1) / maxBatterySteps;
+}
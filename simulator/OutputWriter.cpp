@@ -0,0 +1,98 @@
+#include "OutputWriter.hpp"
+#include <fstream>
+#include <iostream>
+
+OutputWriter::OutputWriter() : buffer(BUFFER_SIZE)
+{
+    thread = std::thread(&OutputWriter::run, this);
+}
+OutputWriter::~OutputWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobQueued.notify_one();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+void OutputWriter::write(const std::filesystem::path &path, Formatter formatter, ErrorHandler onError)
+{
+    submit([this, path, formatter = std::move(formatter)]() { writeFile(path, formatter); }, std::move(onError));
+}
+void OutputWriter::submit(std::function<void()> job, ErrorHandler onError)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(Job{std::move(job), std::move(onError)});
+    }
+    jobQueued.notify_one();
+}
+void OutputWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this]() { return jobs.empty() && !busy; });
+}
+void OutputWriter::writeFile(const std::filesystem::path &path, const Formatter &formatter)
+{
+    std::ofstream writeStream;
+    // Must be set before open to take effect
+    writeStream.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    writeStream.open(path, std::ios_base::out | std::ios_base::trunc);
+    if (!writeStream.is_open())
+    {
+        std::cerr << "Unable to open file." << std::endl;
+        throw std::runtime_error("Unable to open file.");
+    }
+    formatter(writeStream);
+    writeStream.close();
+}
+/**
+ * Queued files are written in the order they were queued, the queue is always drained before the thread stops
+ */
+void OutputWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        jobQueued.wait(lock, [this]() { return !jobs.empty() || stopping; });
+        if (jobs.empty())
+        {
+            return;
+        }
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+        try
+        {
+            job.work();
+        }
+        catch (const std::exception &e)
+        {
+            if (job.onError)
+            {
+                try
+                {
+                    job.onError(e.what());
+                }
+                catch (const std::exception &handlerError)
+                {
+                    std::cerr << "Error: Unable to report output error " << handlerError.what() << std::endl;
+                }
+            }
+            else
+            {
+                std::cerr << "Error: Unable to write output " << e.what() << std::endl;
+            }
+        }
+        lock.lock();
+        busy = false;
+        if (jobs.empty())
+        {
+            drained.notify_all();
+        }
+    }
+}
@@ -0,0 +1,341 @@
+#include "ProcessPool.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    enum class MessageType : uint32_t { TimeLimit, ClearTimeLimit, Result };
+    struct MessageHeader
+    {
+        MessageType type;
+        int64_t limit;
+        uint64_t length;
+    };
+    bool readFully(int fd, void *data, std::size_t size)
+    {
+        auto bytes = static_cast<char *>(data);
+        while (size > 0)
+        {
+            auto count = ::read(fd, bytes, size);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+            bytes += count;
+            size -= count;
+        }
+        return true;
+    }
+    /**
+     * MSG_NOSIGNAL so writing to a worker that already died fails instead of raising SIGPIPE
+     */
+    bool writeFully(int fd, const void *data, std::size_t size)
+    {
+        auto bytes = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            auto count = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                return false;
+            }
+            bytes += count;
+            size -= count;
+        }
+        return true;
+    }
+    bool writeMessage(int fd, MessageType type, int64_t limit, const std::string &payload)
+    {
+        MessageHeader header{type, limit, payload.size()};
+        return writeFully(fd, &header, sizeof(header)) && writeFully(fd, payload.data(), payload.size());
+    }
+}
+
+void ProcessPool::TaskControl::setTimeLimit(Clock::duration limit, const std::string &resultIfKilled) const
+{
+    writeMessage(fd, MessageType::TimeLimit, std::chrono::duration_cast<std::chrono::nanoseconds>(limit).count(), resultIfKilled);
+}
+void ProcessPool::TaskControl::clearTimeLimit() const
+{
+    writeMessage(fd, MessageType::ClearTimeLimit, 0, "");
+}
+
+ProcessPool::ProcessPool(std::size_t numWorkers, Task task) : workers(numWorkers), task(std::move(task))
+{
+    for (std::size_t i = 0; i < workers.size(); i++)
+    {
+        spawn(i);
+    }
+}
+ProcessPool::~ProcessPool()
+{
+    // Closing its socket is what tells an idle worker to exit
+    for (auto &worker : workers)
+    {
+        stop(worker, worker.task.has_value());
+    }
+}
+void ProcessPool::spawn(std::size_t index)
+{
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+    {
+        throw std::runtime_error("Unable to create worker socket");
+    }
+    // Whatever is still buffered would otherwise be printed again by the worker
+    std::cout.flush();
+    std::fflush(nullptr);
+    pid_t pid = ::fork();
+    if (pid < 0)
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error("Unable to fork worker process");
+    }
+    if (pid == 0)
+    {
+        ::close(fds[0]);
+        // A worker holding the socket of another would keep it from seeing the pool close it
+        for (auto &worker : workers)
+        {
+            if (worker.fd >= 0)
+            {
+                ::close(worker.fd);
+            }
+        }
+        serve(fds[1]);
+    }
+    ::close(fds[1]);
+    workers[index] = Worker{pid, fds[0], std::nullopt, std::nullopt, "", std::nullopt};
+}
+void ProcessPool::stop(Worker &worker, bool kill)
+{
+    if (worker.pid < 0)
+    {
+        return;
+    }
+    if (kill)
+    {
+        ::kill(worker.pid, SIGKILL);
+    }
+    ::close(worker.fd);
+    ::waitpid(worker.pid, nullptr, 0);
+    worker = Worker{};
+}
+/**
+ * The worker side, runs tasks until the pool closes the socket. It never returns into the code that forked it
+ */
+void ProcessPool::serve(int fd)
+{
+    TaskControl control(fd);
+    uint64_t index;
+    while (readFully(fd, &index, sizeof(index)))
+    {
+        std::string result;
+        try
+        {
+            result = task(index, control);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: Worker task failed " << e.what() << std::endl;
+        }
+        std::cout.flush();
+        if (!writeMessage(fd, MessageType::Result, 0, result))
+        {
+            break;
+        }
+    }
+    std::cout.flush();
+    ::_exit(0);
+}
+/**
+ * Reads one message of a busy worker, false once the worker is gone
+ */
+bool ProcessPool::receive(Worker &worker, std::optional<std::string> &result)
+{
+    MessageHeader header;
+    if (!readFully(worker.fd, &header, sizeof(header)))
+    {
+        return false;
+    }
+    std::string payload(header.length, '\0');
+    if (!readFully(worker.fd, payload.data(), payload.size()))
+    {
+        return false;
+    }
+    switch (header.type)
+    {
+        case MessageType::TimeLimit:
+            worker.deadline = Clock::now() + std::chrono::nanoseconds(header.limit);
+            worker.resultIfKilled = std::move(payload);
+            break;
+        case MessageType::ClearTimeLimit:
+            worker.deadline = std::nullopt;
+            break;
+        case MessageType::Result:
+            result = std::move(payload);
+            break;
+    }
+    return true;
+}
+void ProcessPool::run(std::size_t taskCount, const ResultHandler &onResult, const GroupOf &groupOf)
+{
+    std::vector<Group> groups;
+    std::optional<std::size_t> lastGroup;
+    for (std::size_t task = 0; task < taskCount; task++)
+    {
+        std::optional<std::size_t> group = groupOf ? std::optional<std::size_t>(groupOf(task)) : std::nullopt;
+        if (groups.empty() || !group || group != lastGroup)
+        {
+            groups.push_back(Group{task, task});
+        }
+        groups.back().end++;
+        lastGroup = group;
+    }
+    std::size_t nextGroup = 0;
+    // The group of the worker first, then one nobody started, then the one with the most tasks left
+    auto pick = [&](Worker &worker) -> std::optional<std::size_t> {
+        if (!worker.group || groups[*worker.group].next == groups[*worker.group].end)
+        {
+            if (nextGroup < groups.size())
+            {
+                worker.group = nextGroup++;
+            }
+            else
+            {
+                auto largest = std::max_element(groups.begin(), groups.end(), [](const Group &first, const Group &second) {
+                    return first.end - first.next < second.end - second.next;
+                });
+                if (largest == groups.end() || largest->next == largest->end)
+                {
+                    return std::nullopt;
+                }
+                worker.group = largest - groups.begin();
+            }
+        }
+        return groups[*worker.group].next++;
+    };
+    std::size_t dispatchedTasks = 0;
+    std::size_t finishedTasks = 0;
+    auto report = [&](std::size_t task, Outcome outcome, const std::string &result) {
+        finishedTasks++;
+        onResult(task, outcome, result);
+    };
+    auto finish = [&](std::size_t index, const std::string &result) {
+        auto task = *workers[index].task;
+        workers[index].task = std::nullopt;
+        workers[index].deadline = std::nullopt;
+        report(task, Outcome::Finished, result);
+    };
+    // The replacement carries on with the group of the worker it replaces
+    auto respawn = [&](std::size_t index, bool kill) {
+        auto group = workers[index].group;
+        stop(workers[index], kill);
+        spawn(index);
+        workers[index].group = group;
+    };
+    auto replace = [&](std::size_t index, Outcome outcome) {
+        auto task = *workers[index].task;
+        auto result = workers[index].resultIfKilled;
+        respawn(index, outcome == Outcome::TimedOut);
+        report(task, outcome, result);
+    };
+    while (finishedTasks < taskCount)
+    {
+        for (std::size_t i = 0; i < workers.size() && dispatchedTasks < taskCount; i++)
+        {
+            if (workers[i].task)
+            {
+                continue;
+            }
+            auto task = pick(workers[i]);
+            if (!task)
+            {
+                break;
+            }
+            uint64_t index = *task;
+            if (!writeFully(workers[i].fd, &index, sizeof(index)))
+            {
+                // Died while idle, nothing of it to report, the task goes back to its group
+                groups[*workers[i].group].next--;
+                respawn(i, false);
+                continue;
+            }
+            workers[i].task = *task;
+            workers[i].resultIfKilled.clear();
+            dispatchedTasks++;
+        }
+        std::vector<pollfd> pollFds;
+        std::vector<std::size_t> polled;
+        std::optional<Clock::time_point> nearestDeadline;
+        for (std::size_t i = 0; i < workers.size(); i++)
+        {
+            if (!workers[i].task)
+            {
+                continue;
+            }
+            pollFds.push_back(pollfd{workers[i].fd, POLLIN, 0});
+            polled.push_back(i);
+            if (workers[i].deadline && (!nearestDeadline || *workers[i].deadline < *nearestDeadline))
+            {
+                nearestDeadline = workers[i].deadline;
+            }
+        }
+        if (pollFds.empty())
+        {
+            continue;
+        }
+        int timeout = -1;
+        if (nearestDeadline)
+        {
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*nearestDeadline - Clock::now());
+            timeout = std::max<int>(0, remaining.count());
+        }
+        if (::poll(pollFds.data(), pollFds.size(), timeout) < 0 && errno != EINTR)
+        {
+            throw std::runtime_error("Unable to wait for worker processes");
+        }
+        for (std::size_t i = 0; i < pollFds.size(); i++)
+        {
+            if (pollFds[i].revents == 0)
+            {
+                continue;
+            }
+            auto index = polled[i];
+            std::optional<std::string> result;
+            if (!receive(workers[index], result))
+            {
+                replace(index, Outcome::Crashed);
+            }
+            else if (result)
+            {
+                finish(index, *result);
+            }
+        }
+        auto now = Clock::now();
+        for (std::size_t i = 0; i < workers.size(); i++)
+        {
+            if (workers[i].task && workers[i].deadline && *workers[i].deadline <= now)
+            {
+                replace(i, Outcome::TimedOut);
+            }
+        }
+    }
+}
@@ -39,13 +39,18 @@ SimulationArguments::SimulationArguments(int argc, char** argv)
     std::string housePath;
     std::string algoPath;
     uint32_t numThreads;
+    std::size_t memoryBudget;
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help,h", "produce help message")
         ("summary_only","create only summary csv file")
+        ("stream_output","write the steps of each run to its output file while simulating")
+        ("isolate","run the simulations in worker processes, a run stuck past its time limit is killed")
+        ("cpu_time","enforce the time limit of a run on the CPU time of its algorithm instead of wall time")
         ("house_path", po::value<std::string>(&housePath), "set house files path")
         ("algo_path", po::value<std::string>(&algoPath), "set algorithm files path")
-        ("num_threads", po::value<uint32_t>(&numThreads)->default_value(10), "set number of threads");
+        ("num_threads", po::value<uint32_t>(&numThreads)->default_value(10), "set number of threads, or of worker processes with isolate")
+        ("memory_budget", po::value<std::size_t>(&memoryBudget)->default_value(0), "set the memory in MB the simulations running at once may use, 0 for no limit");
 
     po::variables_map vm;
     try
@@ -81,6 +86,10 @@ SimulationArguments::SimulationArguments(int argc, char** argv)
     insertFilesWithExtension(housePath, houseFiles, ".house");
     insertFilesWithExtension(algoPath, algoFiles, ".so");
     this->summaryOnly = vm.count("summary_only");
+    this->streamOutput = vm.count("stream_output");
+    this->isolated = vm.count("isolate");
+    this->cpuTime = vm.count("cpu_time");
     this->numThreads = numThreads;
+    this->memoryBudget = memoryBudget * 1024 * 1024;
 }
 
@@ -0,0 +1,60 @@
+#include "StepStreamWriter.hpp"
+#include "Step.hpp"
+#include <iostream>
+
+StepStreamWriter::StepStreamWriter(const std::filesystem::path &outputPath) : outputPath(outputPath), buffer(BUFFER_SIZE)
+{
+    spoolPath = outputPath;
+    spoolPath += ".steps";
+    spool.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    spool.open(spoolPath, std::ios_base::out | std::ios_base::trunc);
+    if (!spool.is_open())
+    {
+        std::cerr << "Unable to open step spool file." << std::endl;
+        throw std::runtime_error("Unable to open step spool file.");
+    }
+}
+StepStreamWriter::~StepStreamWriter()
+{
+    if (spool.is_open())
+    {
+        spool.close();
+    }
+    std::error_code ec;
+    std::filesystem::remove(spoolPath, ec);
+}
+void StepStreamWriter::write(Step step, std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // A timed out run may still be stepping after the out file was written, those steps are not part of the record
+    if (finalized)
+    {
+        return;
+    }
+    for (std::size_t i = 0; i < count; i++)
+    {
+        spool << step;
+    }
+}
+std::filesystem::path StepStreamWriter::finalize(const std::function<void(std::ostream &)> &writeHeader)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    finalized = true;
+    spool.close();
+    std::ofstream writeStream(outputPath);
+    if (!writeStream.is_open())
+    {
+        std::cerr << "Unable to open file." << std::endl;
+        throw std::runtime_error("Unable to open file.");
+    }
+    writeHeader(writeStream);
+    std::ifstream spooledSteps(spoolPath);
+    // Streaming an empty buffer would set the failbit on the out file
+    if (std::filesystem::file_size(spoolPath) > 0)
+    {
+        writeStream << spooledSteps.rdbuf();
+    }
+    writeStream << std::endl;
+    writeStream.close();
+    return outputPath;
+}
@@ -0,0 +1,117 @@
+#include "SummaryTable.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+SummaryTable::SummaryTable(const std::filesystem::path &path) : path(path)
+{
+    load();
+}
+void SummaryTable::load()
+{
+    std::ifstream inFile(path);
+    if (!inFile.is_open())
+    {
+        return;
+    }
+    std::string line;
+    bool firstLine = true;
+    while (std::getline(inFile, line))
+    {
+        std::stringstream ss(line);
+        std::string cell;
+
+        if (firstLine)
+        {
+            while (std::getline(ss, cell, ','))
+            {
+                if (!cell.empty())
+                {
+                    getHouseIndex(cell);
+                }
+            }
+            firstLine = false;
+            continue;
+        }
+        std::vector<std::string> rowData;
+        bool hasData = false;
+
+        while (std::getline(ss, cell, ','))
+        {
+            rowData.push_back(cell);
+            if (!cell.empty())
+            {
+                hasData = true;
+            }
+        }
+        if (hasData)
+        {
+            algorithmIndices.emplace(rowData[0], tableData.size());
+            tableData.push_back(rowData);
+        }
+    }
+}
+std::size_t SummaryTable::getHouseIndex(const std::string &houseName)
+{
+    auto house = houseIndices.find(houseName);
+    if (house != houseIndices.end())
+    {
+        return house->second;
+    }
+    houseNames.push_back(houseName);
+    return houseIndices.emplace(houseName, houseNames.size() - 1).first->second;
+}
+std::size_t SummaryTable::getAlgorithmIndex(const std::string &algorithmName)
+{
+    auto algorithm = algorithmIndices.find(algorithmName);
+    if (algorithm != algorithmIndices.end())
+    {
+        return algorithm->second;
+    }
+    tableData.push_back(std::vector<std::string>(houseNames.size() + 1, ""));
+    tableData.back()[0] = algorithmName;
+    return algorithmIndices.emplace(algorithmName, tableData.size() - 1).first->second;
+}
+void SummaryTable::set(const std::string &algorithmName, const std::string &houseName, std::optional<uint32_t> score)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t houseIndex = getHouseIndex(houseName);
+    auto &row = tableData[getAlgorithmIndex(algorithmName)];
+    if (row.size() <= houseIndex + 1)
+    {
+        row.resize(houseIndex + 2, "");
+    }
+    row[houseIndex + 1] = score.has_value() ? std::to_string(*score) : "";
+    changed = true;
+}
+bool SummaryTable::isChanged()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return changed;
+}
+void SummaryTable::write()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ofstream outFile(path, std::ios_base::out | std::ios_base::trunc);
+    if (!outFile.is_open())
+    {
+        std::cerr << "Unable to open summary file." << std::endl;
+        throw std::runtime_error("Unable to open summary file.");
+    }
+    outFile << ",";
+    for (const auto &house : houseNames)
+    {
+        outFile << house << ",";
+    }
+    outFile << "\n";
+
+    for (const auto &row : tableData)
+    {
+        for (const auto &cell : row)
+        {
+            outFile << cell << ",";
+        }
+        outFile << "\n";
+    }
+    changed = false;
+}
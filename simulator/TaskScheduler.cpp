@@ -0,0 +1,173 @@
+#include "TaskScheduler.hpp"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+TaskScheduler::TaskScheduler(std::size_t algorithmCount, std::size_t numWorkers) : algorithms(algorithmCount), rankingStats(algorithmCount), numWorkers(std::max<std::size_t>(numWorkers, 1))
+{
+}
+void TaskScheduler::add(const std::filesystem::path &houseFile, std::optional<HouseHeader> header)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::size_t> houseAlgorithms(algorithms.size());
+    std::iota(houseAlgorithms.begin(), houseAlgorithms.end(), 0);
+    houses.push_back(House{houseFile, header, std::move(houseAlgorithms)});
+}
+TaskScheduler::Clock::duration TaskScheduler::estimate(const Task &task)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return estimateLocked(task, algorithms);
+}
+/**
+ * Most runs end long before MaxSteps, once the house is clean, so the steps are expected to grow with the size of the house.
+ * A house that cannot be read fails right away, it costs nothing
+ */
+TaskScheduler::Clock::duration TaskScheduler::estimateLocked(const Task &task, const std::vector<AlgorithmStats> &stats) const
+{
+    if (!task.header)
+    {
+        return Clock::duration::zero();
+    }
+    const auto &algorithmStats = stats[task.algorithm];
+    auto tiles = static_cast<uint64_t>(task.header->rows) * task.header->cols;
+    double stepsPerTile = (PRIOR_STEPS_PER_TILE * PRIOR_WEIGHT_TILES + algorithmStats.steps) / (PRIOR_WEIGHT_TILES + algorithmStats.tiles);
+    double timePerStep = (PRIOR_TIME_PER_STEP.count() * PRIOR_WEIGHT_STEPS + algorithmStats.stepSeconds * 1e9) / (PRIOR_WEIGHT_STEPS + algorithmStats.steps);
+    double steps = std::min<double>(task.header->maxSteps, stepsPerTile * tiles);
+    return std::chrono::nanoseconds(static_cast<int64_t>(steps * timePerStep)) + TIME_PER_TILE * tiles;
+}
+/**
+ * A house takes as long as its longest run, by the ranking statistics
+ */
+TaskScheduler::Clock::duration TaskScheduler::houseCostLocked(const House &house) const
+{
+    auto cost = Clock::duration::zero();
+    for (auto algorithm : house.algorithms)
+    {
+        cost = std::max(cost, estimateLocked(Task{house.houseFile, algorithm, house.header}, rankingStats));
+    }
+    return cost;
+}
+/**
+ * Orders the runs of the house by what was learned when it is started, the longest is handed out first
+ */
+void TaskScheduler::openLocked(House house)
+{
+    std::sort(house.algorithms.begin(), house.algorithms.end(), [&](std::size_t first, std::size_t second) {
+        return estimateLocked(Task{house.houseFile, first, house.header}, algorithms) < estimateLocked(Task{house.houseFile, second, house.header}, algorithms);
+    });
+    openHouse = std::move(house);
+}
+/**
+ * Moves the small houses to the fast lane and predicts the makespan of the batch by placing each run, longest first,
+ * on the least loaded worker
+ */
+TaskScheduler::Clock::duration TaskScheduler::start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Clock::duration> costs;
+    std::vector<House> slowHouses;
+    for (auto &house : houses)
+    {
+        auto houseCost = Clock::duration::zero();
+        for (auto algorithm : house.algorithms)
+        {
+            costs.push_back(estimateLocked(Task{house.houseFile, algorithm, house.header}, rankingStats));
+            houseCost = std::max(houseCost, costs.back());
+        }
+        if (houseCost < FAST_LANE_LIMIT)
+        {
+            fastLane.push_back(std::move(house));
+        }
+        else
+        {
+            slowLane.push(QueuedHouse{houseCost, slowHouses.size()});
+            slowHouses.push_back(std::move(house));
+        }
+    }
+    houses = std::move(slowHouses);
+    std::sort(costs.begin(), costs.end(), std::greater<>());
+    std::priority_queue<Clock::duration, std::vector<Clock::duration>, std::greater<>> loads;
+    for (std::size_t i = 0; i < numWorkers; i++)
+    {
+        loads.push(Clock::duration::zero());
+    }
+    Clock::duration makespan = Clock::duration::zero();
+    for (const auto &cost : costs)
+    {
+        auto load = loads.top() + cost;
+        loads.pop();
+        loads.push(load);
+        makespan = std::max(makespan, load);
+    }
+    return makespan;
+}
+/**
+ * Costs every queued house again under the refreshed ranking statistics, learning may have moved any of them up or down
+ */
+void TaskScheduler::rerankLocked()
+{
+    std::vector<QueuedHouse> queued;
+    queued.reserve(slowLane.size());
+    while (!slowLane.empty())
+    {
+        queued.push_back(QueuedHouse{houseCostLocked(houses[slowLane.top().house]), slowLane.top().house});
+        slowLane.pop();
+    }
+    slowLane = std::priority_queue<QueuedHouse>(std::less<QueuedHouse>(), std::move(queued));
+    rankingChanged = false;
+}
+/**
+ * The next house is only picked once every run of the open one was handed out, by what was learned up to then
+ */
+std::optional<TaskScheduler::Task> TaskScheduler::next()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!openHouse || openHouse->algorithms.empty())
+    {
+        openHouse.reset();
+        if (!fastLane.empty())
+        {
+            openLocked(std::move(fastLane.back()));
+            fastLane.pop_back();
+        }
+        else if (!slowLane.empty())
+        {
+            if (rankingChanged)
+            {
+                rerankLocked();
+            }
+            openLocked(std::move(houses[slowLane.top().house]));
+            slowLane.pop();
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+    auto algorithm = openHouse->algorithms.back();
+    openHouse->algorithms.pop_back();
+    return Task{openHouse->houseFile, algorithm, openHouse->header};
+}
+/**
+ * Learns how many steps the algorithm takes per tile and how long a step takes, from the steps the run actually took
+ */
+void TaskScheduler::finished(const Task &task, Clock::duration elapsed, std::size_t steps)
+{
+    if (!task.header)
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &stats = algorithms[task.algorithm];
+    auto tiles = static_cast<uint64_t>(task.header->rows) * task.header->cols;
+    stats.stepSeconds += std::max(std::chrono::duration<double>(elapsed - TIME_PER_TILE * tiles).count(), 0.0);
+    stats.steps += steps;
+    stats.tiles += tiles;
+    finishedRuns++;
+    if ((finishedRuns & (finishedRuns - 1)) == 0)
+    {
+        rankingStats = algorithms;
+        rankingChanged = true;
+    }
+}
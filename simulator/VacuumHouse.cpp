@@ -3,130 +3,176 @@
 #include <sstream>
 #include <cassert>
 
-template <typename T>
-bool inVectorBounds(const std::vector<std::vector<T>> &locations, uint32_t i, uint32_t j)
-{
-    return i < locations.size() && j < locations[i].size();
-}
 bool inVectorStringBounds (const std::vector<std::string>& locations, uint32_t i, uint32_t j)
 {
     return i < locations.size() && j < locations[i].size();
 }
 
-bool VacuumHouse::inBounds(Coordinate<size_t> &coordinate) const
-{
-    return inVectorBounds(houseLocations, coordinate.getX(), coordinate.getY());
-}
-std::vector<std::vector<HouseLocation>> VacuumHouse::constructHouseLocation(const std::vector<std::string> &locations, uint32_t rows, uint32_t cols)
+std::vector<HouseLocation> VacuumHouse::constructHouseLocation(const std::vector<std::string> &locations, uint32_t rows, uint32_t cols)
 {
-    std::vector<std::vector<HouseLocation>> houseLocations;
+    std::vector<HouseLocation> houseLocations((rows + 2) * (cols + 2), HouseLocation(LocationType::WALL));
     for (size_t i = 0; i < rows; i++) {
-        std::vector<HouseLocation> houseRow;
         for (size_t j = 0; j < cols; j++) {
             char location_represatation = ' ';
             if(inVectorStringBounds(locations,i,j)){
                 location_represatation = locations[i][j];
             }
-            HouseLocation location = HouseLocation(location_represatation);
-            houseRow.push_back(location);
+            houseLocations[(i + 1) * (cols + 2) + j + 1] = HouseLocation(location_represatation);
         }
-        houseLocations.push_back(houseRow);
     }
     return houseLocations;
 }
 
-Coordinate<size_t> findChargingStation(std::vector<std::vector<HouseLocation>>& houseLocations, uint32_t rows, uint32_t cols) {
-    HouseLocation* chargingStationLocation = nullptr;
-    Coordinate<size_t>* chargingStationCoordinate = nullptr;
-    for(size_t i = 0; i < rows; i++){
-        for(size_t j = 0; j < cols; j++){
-            if (houseLocations[i][j].getLocationType() == LocationType::CHARGING_STATION) {
-                if (chargingStationLocation != nullptr) {
-                    throw std::invalid_argument("Multiple charging stations found in house");
+std::vector<uint8_t> VacuumHouse::constructWallMasks(const Layout &layout)
+{
+    std::vector<uint8_t> wallMasks(layout.houseLocations.size(), 0);
+    for (size_t i = 1; i <= layout.rows; i++) {
+        for (size_t j = 1; j <= layout.cols; j++) {
+            size_t index = i * getStride(layout) + j;
+            for (auto direction : {Direction::North, Direction::East, Direction::South, Direction::West}) {
+                if (layout.houseLocations[index + getStepOffset(layout, DirectionTools::toStep(direction))].getLocationType() == LocationType::WALL) {
+                    wallMasks[index] |= getWallBit(direction);
                 }
-                chargingStationLocation = &houseLocations[i][j];
-                chargingStationCoordinate = new Coordinate(i,j);
             }
         }
     }
-    if (chargingStationLocation == nullptr) {
+    return wallMasks;
+}
+
+size_t findChargingStation(const std::vector<HouseLocation>& houseLocations) {
+    std::optional<size_t> chargingStationIndex = std::nullopt;
+    for(size_t i = 0; i < houseLocations.size(); i++){
+        if (houseLocations[i].getLocationType() == LocationType::CHARGING_STATION) {
+            if (chargingStationIndex.has_value()) {
+                throw std::invalid_argument("Multiple charging stations found in house");
+            }
+            chargingStationIndex = i;
+        }
+    }
+    if (!chargingStationIndex.has_value()) {
         throw std::invalid_argument("No charging station found in house");
     }
-    std::stringstream ss;
-    ss << *chargingStationLocation;
-    return *chargingStationCoordinate;
+    return *chargingStationIndex;
 }
 
-HouseLocation& VacuumHouse::getDirectionLocation(const Direction& direction)
+std::ptrdiff_t VacuumHouse::getStepOffset(const Layout &layout, const Step &step)
 {
-    Step step = DirectionTools::toStep(direction);
-    return getStepLocation(step);
+    switch (step)
+    {
+        case Step::North:
+            return -static_cast<std::ptrdiff_t>(getStride(layout));
+        case Step::South:
+            return static_cast<std::ptrdiff_t>(getStride(layout));
+        case Step::East:
+            return 1;
+        case Step::West:
+            return -1;
+        case Step::Finish:
+        case Step::Stay:
+            return 0;
+    }
+    return 0;
 }
-const HouseLocation &VacuumHouse::getDirectionLocation(const Direction &direction) const
+
+const HouseLocation &VacuumHouse::getTile(size_t index) const
 {
-    auto& temp =  const_cast<VacuumHouse*>(this)->getDirectionLocation(direction);
-    return temp;
+    const HouseLocation *cleanedTile = cleanedTiles.find(index);
+    if (cleanedTile != nullptr) {
+        return *cleanedTile;
+    }
+    return layout->houseLocations[index];
 }
-
-HouseLocation& VacuumHouse::getStepLocation(const Step &step)
+/**
+ * The layout is shared between runs, a tile is copied into this run's overlay the first time it may be changed
+ */
+HouseLocation &VacuumHouse::getMutableTile(size_t index)
 {
-    auto coordinate = currentLocation.getStep(step);
-    if (!inBounds(coordinate))
-    {
-        return logicalWall;
+    HouseLocation *cleanedTile = cleanedTiles.find(index);
+    if (cleanedTile != nullptr) {
+        return *cleanedTile;
     }
+    return cleanedTiles.emplace(index, layout->houseLocations[index]);
+}
 
-    return houseLocations[coordinate.getX()][coordinate.getY()];
-};
+HouseLocation VacuumHouse::getDirectionLocation(const Direction &direction) const
+{
+    return getTile(currentLocation + getStepOffset(DirectionTools::toStep(direction)));
+}
 
 std::ostream& operator<<(std::ostream& os, const VacuumHouse& house)
 {
-    for (const auto& row : house.houseLocations) {
-        for (const auto& location : row) {
-            os << location;
+    for (size_t i = 1; i <= house.layout->rows; i++) {
+        for (size_t j = 1; j <= house.layout->cols; j++) {
+            os << house.getTile(i * house.getStride() + j);
         }
         os << std::endl;
     }
     return os;
 }
 
-VacuumHouse::VacuumHouse(const std::vector<std::string>& locations,uint32_t rows,uint32_t cols) :logicalWall(LocationType::WALL){
-
-    houseLocations = constructHouseLocation(locations,rows,cols);
-    auto coordinates = findChargingStation(houseLocations,rows,cols);
-    chargingStation = &houseLocations[coordinates.getX()][coordinates.getY()];
-    currentLocation = coordinates;
-}
-uint32_t VacuumHouse::getTotalDirt() const{
-    uint32_t totalDirt = 0;
-    for (const auto& row : houseLocations) {
-        for (const auto& location : row) {
-            if (location.getDirtLevel()) {
-                totalDirt += location.getDirtLevel();
-            }
+VacuumHouse::VacuumHouse(const std::vector<std::string>& locations,uint32_t rows,uint32_t cols) {
+    auto newLayout = std::make_shared<Layout>();
+    newLayout->rows = rows;
+    newLayout->cols = cols;
+    newLayout->houseLocations = constructHouseLocation(locations,rows,cols);
+    newLayout->wallMasks = constructWallMasks(*newLayout);
+    newLayout->chargingStation = findChargingStation(newLayout->houseLocations);
+    accumulateDirt(*newLayout);
+    layout = newLayout;
+    currentLocation = layout->chargingStation;
+    totalDirt = layout->totalDirt;
+    dirtyTileCount = layout->dirtyTileCount;
+}
+void VacuumHouse::accumulateDirt(Layout &layout)
+{
+    layout.totalDirt = 0;
+    layout.dirtyTileCount = 0;
+    layout.rowBandDirt.assign((layout.rows + ROW_BAND_HEIGHT - 1) / ROW_BAND_HEIGHT, 0);
+    for (size_t i = 0; i < layout.houseLocations.size(); i++) {
+        const auto& location = layout.houseLocations[i];
+        if (location.getDirtLevel()) {
+            layout.totalDirt += location.getDirtLevel();
+            layout.rowBandDirt[(i / getStride(layout) - 1) / ROW_BAND_HEIGHT] += location.getDirtLevel();
+            layout.dirtyTileCount++;
         }
     }
-    return totalDirt;
 }
-const HouseLocation& VacuumHouse::getCurrentLocation() const{
-    return const_cast<VacuumHouse*>(this)->getCurrentLocation();
+uint32_t VacuumHouse::getRowBandDirt(size_t band) const
+{
+    if (band >= layout->rowBandDirt.size()) {
+        return 0;
+    }
+    if (rowBandDirt.empty()) {
+        return layout->rowBandDirt[band];
+    }
+    return rowBandDirt[band];
 }
-
-HouseLocation& VacuumHouse::getCurrentLocation(){
-    return houseLocations[currentLocation.getX()][currentLocation.getY()];
+/**
+ * All dirt changes go through here so the aggregates stay in sync with the tiles without rescanning the grid
+ */
+void VacuumHouse::setDirtLevel(HouseLocation &location, size_t row, uint8_t dirtLevel)
+{
+    if (rowBandDirt.empty()) {
+        rowBandDirt = layout->rowBandDirt;
+    }
+    uint8_t previousDirtLevel = location.getDirtLevel();
+    location.setDirtLevel(dirtLevel);
+    totalDirt = totalDirt - previousDirtLevel + dirtLevel;
+    rowBandDirt[row / ROW_BAND_HEIGHT] = rowBandDirt[row / ROW_BAND_HEIGHT] - previousDirtLevel + dirtLevel;
+    if (previousDirtLevel && !dirtLevel) {
+        dirtyTileCount--;
+    }
+    else if (!previousDirtLevel && dirtLevel) {
+        dirtyTileCount++;
+    }
 }
 bool VacuumHouse::is_move(const Step& step)
 {
-    return DirectionTools::isStayInPlaceStep(step) || is_move(DirectionTools::reduceStepToDirection(step));
+    return DirectionTools::isStayInPlaceStep(step) || !isWall(DirectionTools::reduceStepToDirection(step));
 }
 bool VacuumHouse::is_move(const Direction& direction)
 {
-    auto newLocation = getDirectionLocation(direction);
-    if (&newLocation == &logicalWall || newLocation.getLocationType() == LocationType::WALL){
-        return false;
-    }
-
-    return true;
+    return !isWall(direction);
 }
 void VacuumHouse::move(const Direction& direction)
 {
@@ -134,7 +180,7 @@ void VacuumHouse::move(const Direction& direction)
         std::cerr << "Error: Attempted to move into wall" << std::endl;
         return;
     }
-    currentLocation = currentLocation.getDirection(direction);
+    currentLocation += getStepOffset(DirectionTools::toStep(direction));
 }
 void VacuumHouse::move(const Step& direction)
 {
@@ -146,8 +192,9 @@ void VacuumHouse::move(const Step& direction)
 }
 
 void VacuumHouse::cleanCurrentLocation() {
-    auto& location = getCurrentLocation();
-    if (location.getLocationType() == LocationType::HOUSE_TILE){
-        location.setDirtLevel(std::max(location.getDirtLevel() - 1,0));
+    const auto& location = getTile(currentLocation);
+    if (location.getLocationType() == LocationType::HOUSE_TILE && location.getDirtLevel() > 0){
+        uint8_t dirtLevel = location.getDirtLevel() - 1;
+        setDirtLevel(getMutableTile(currentLocation), getRow(currentLocation), dirtLevel);
     }
-}
\ No newline at end of file
+}
@@ -6,7 +6,7 @@
 #include <memory>
 #include <regex>
 
-int extractNumberFromString(const std::string& line,const std::string& name) {
+int extractNumberFromString(const std::string& line,const std::string& name, bool reportErrors = true) {
     std::string pattern = name + R"(\s*=\s*(\d+))";
     std::regex regexPattern(pattern);
     std::smatch match;
@@ -15,7 +15,9 @@ int extractNumberFromString(const std::string& line,const std::string& name) {
             return std::stoi(match.str(1));
         }
         catch (const std::exception& e) {
-            std::cerr << "Failed Parsing for " << line << " Reason: " << e.what() << '\n';
+            if (reportErrors) {
+                std::cerr << "Failed Parsing for " << line << " Reason: " << e.what() << '\n';
+            }
             return -1;
         }
     }
@@ -83,4 +85,27 @@ std::unique_ptr<VacuumPayload> VacuumParser::parse(const std::filesystem::path&
         return nullptr;
     }
     return nullptr;
-}
\ No newline at end of file
+}
+/**
+ * Reads only the header lines and reports nothing, a house that fails here fails again with its errors once it is parsed
+ */
+std::optional<HouseHeader> VacuumParser::parseHeader(const std::filesystem::path& fileInputpath)
+{
+    std::ifstream file(fileInputpath);
+    std::vector<std::string> lines;
+    std::string line;
+    while (lines.size() < 5 && std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    if (lines.size() < 5) {
+        return std::nullopt;
+    }
+    int maxSteps = extractNumberFromString(lines[1], "MaxSteps", false);
+    int maxBattery = extractNumberFromString(lines[2], "MaxBattery", false);
+    int rows = extractNumberFromString(lines[3], "Rows", false);
+    int cols = extractNumberFromString(lines[4], "Cols", false);
+    if (maxSteps < 0 || maxBattery < 0 || rows < 0 || cols < 0) {
+        return std::nullopt;
+    }
+    return HouseHeader{static_cast<uint32_t>(maxSteps), static_cast<uint32_t>(maxBattery), static_cast<uint32_t>(rows), static_cast<uint32_t>(cols)};
+}
@@ -1,8 +1,12 @@
 #include "VacuumSimulator.hpp"
 #include "ScoreCalculator.hpp"
 #include "VacuumParser.hpp"
+#include "ChargingAlgorithm.h"
+#include "PlanningAlgorithm.h"
+#include "SummaryTable.hpp"
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 
 void VacuumSimulator::setAlgorithm(std::unique_ptr<AbstractAlgorithm> algorithm)
@@ -20,7 +24,6 @@ const std::filesystem::path getSummaryFilePath()
 }
 void VacuumSimulator::run()
 {
-    this->timedOut = false;
     calculate();
     if (record == nullptr)
     {
@@ -42,11 +45,52 @@ void VacuumSimulator::canExport()
     
 }
 
+/**
+ * Steps are written to disk as they are made instead of being kept in the record, exportRecord then only adds the header
+ */
+void VacuumSimulator::streamRecord(std::string algorithmName)
+{
+    stepWriter = std::make_unique<StepStreamWriter>(getOutFilePath(fileInputpath, algorithmName));
+}
+
+/**
+ * Only the header is formatted here, the steps are formatted and written on the output thread
+ */
+std::filesystem::path VacuumSimulator::exportRecord(std::string algorithmName, OutputWriter &output, OutputWriter::ErrorHandler onError)
+{
+    auto fileOutputpath = getOutFilePath(fileInputpath, algorithmName);
+    canExport();
+    std::ostringstream headerStream;
+    writeOutHeader(headerStream);
+    auto header = headerStream.str();
+    if (stepWriter)
+    {
+        std::shared_ptr<StepStreamWriter> writer = std::move(stepWriter);
+        output.submit([writer, header]() { writer->finalize([&](std::ostream &writeStream) { writeStream << header; }); }, std::move(onError));
+        return fileOutputpath;
+    }
+    if (!record->isKeepingHistory())
+    {
+        std::cerr << "Steps were not recorded, cannot export." << std::endl;
+        throw std::runtime_error("Steps were not recorded.");
+    }
+    output.write(fileOutputpath, [record = record, header](std::ostream &writeStream) { writeStream << header << *record << std::endl; }, std::move(onError));
+    return fileOutputpath;
+}
 std::filesystem::path VacuumSimulator::exportRecord(std::string algorithmName)
 {
     auto fileOutputpath = getOutFilePath(fileInputpath, algorithmName);
-    std::ofstream writeStream(fileOutputpath);
     canExport();
+    if (stepWriter)
+    {
+        return stepWriter->finalize([&](std::ostream &writeStream) { writeOutHeader(writeStream); });
+    }
+    if (!record->isKeepingHistory())
+    {
+        std::cerr << "Steps were not recorded, cannot export." << std::endl;
+        throw std::runtime_error("Steps were not recorded.");
+    }
+    std::ofstream writeStream(fileOutputpath);
     if (!writeStream.is_open())
     {
         std::cerr << "Unable to open file." << std::endl;    
@@ -59,9 +103,9 @@ std::filesystem::path VacuumSimulator::exportRecord(std::string algorithmName)
 std::filesystem::path VacuumSimulator::exportSummary(std::string algorithmName,bool errored)
 {
     auto fileOutputpath = getSummaryFilePath();
-    std::string houseName = fileInputpath.stem().string();
-    canExport();
-    writeSummary(houseName,fileOutputpath,algorithmName,errored);
+    SummaryTable summary(fileOutputpath);
+    summary.set(algorithmName, getHouseName(), getScore(errored));
+    summary.write();
     return fileOutputpath;
 }
 std::shared_ptr<CleaningRecord> VacuumSimulator::calculate()
@@ -76,25 +120,93 @@ std::shared_ptr<CleaningRecord> VacuumSimulator::calculate()
     algorithm->setWallsSensor(runPayload.getHouse());
     algorithm->setDirtSensor(runPayload.getHouse());
     algorithm->setMaxSteps(runPayload.getMaxSteps());
-    record = std::make_shared<CleaningRecord>(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, runPayload.getBattery().getBatteryState(), runPayload.getHouse().getTotalDirt()), runPayload.getMaxSteps());
-    while (record->getMaxSteps() >= record->size() && !timedOut)
+    if (auto snapshotAlgorithm = dynamic_cast<SensorSnapshotAlgorithm *>(algorithm.get()))
     {
-        auto step = algorithm->nextStep();
-        if (step == Step::Finish)
+        snapshotAlgorithm->setSensorSnapshot(runPayload);
+    }
+    record = std::make_shared<CleaningRecord>(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, runPayload.getBattery().getBatteryState(), runPayload.getHouse().getTotalDirt()), runPayload.getMaxSteps(), keepHistory && stepWriter == nullptr);
+    auto planningAlgorithm = dynamic_cast<PlanningAlgorithm *>(algorithm.get());
+    bool running = true;
+    while (running && record->getMaxSteps() >= record->size() && !timedOut)
+    {
+        if (planningAlgorithm == nullptr)
         {
-            record->add(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Finish, runPayload.getBattery().getBatteryState(), runPayload.getHouse().getTotalDirt()));
-            break;
+            auto step = algorithm->nextStep();
+            // The run may have timed out while the algorithm was deciding
+            running = !timedOut && takeStep(runPayload, step);
+            continue;
         }
-        auto nextMove = applyStep(runPayload, step);
-        if (!nextMove.has_value())
+        /*
+            Every planned step after the first is only taken if the algorithm confirms its plan still holds
+        */
+        auto steps = planningAlgorithm->nextSteps();
+        for (std::size_t i = 0; running && i < steps.size(); i++)
         {
-            std::cerr << "Invalid step returned by algorithm, terminating execution" << std::endl;
-            break;
+            if (timedOut || (i > 0 && (record->getMaxSteps() < record->size() || !planningAlgorithm->continuePlan())))
+            {
+                break;
+            }
+            running = takeStep(runPayload, steps[i]);
         }
-        record->add(nextMove.value());
     }
     return record;
 }
+/**
+ * Applies a single step to the run and records it, returns false once the run is over
+ */
+bool VacuumSimulator::takeStep(VacuumPayload &runPayload, Step step)
+{
+    if (step == Step::Finish)
+    {
+        record->add(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Finish, runPayload.getBattery().getBatteryState(), runPayload.getHouse().getTotalDirt()));
+        if (stepWriter)
+        {
+            stepWriter->write(step);
+        }
+        return false;
+    }
+    auto nextMove = applyStep(runPayload, step);
+    if (!nextMove.has_value())
+    {
+        std::cerr << "Invalid step returned by algorithm, terminating execution" << std::endl;
+        return false;
+    }
+    record->add(nextMove.value());
+    if (stepWriter)
+    {
+        stepWriter->write(step);
+    }
+    if (step == Step::Stay && nextMove->isAtDockingStation())
+    {
+        fastForwardCharging(runPayload);
+    }
+    return true;
+}
+/**
+ * Applies in one go the rest of a charge the algorithm already committed to, the record and the out file
+ * look exactly as if each Stay was returned by nextStep
+ */
+void VacuumSimulator::fastForwardCharging(VacuumPayload &payload)
+{
+    auto chargingAlgorithm = dynamic_cast<ChargingAlgorithm *>(algorithm.get());
+    if (chargingAlgorithm == nullptr || record->size() >= record->getMaxSteps())
+    {
+        return;
+    }
+    auto chargeSteps = static_cast<uint32_t>(chargingAlgorithm->takeChargeSteps(record->getMaxSteps() - record->size()));
+    if (chargeSteps == 0)
+    {
+        return;
+    }
+    auto &battery = payload.getBattery();
+    auto batteryBefore = battery;
+    battery.charge(chargeSteps);
+    record->addCharging(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, battery.getBatteryState(), payload.getHouse().getTotalDirt()), chargeSteps, batteryBefore);
+    if (stepWriter)
+    {
+        stepWriter->write(Step::Stay, chargeSteps);
+    }
+}
 
 std::optional<CleaningRecordStep> VacuumSimulator::applyStep(VacuumPayload &payload, Step step)
 {
@@ -145,149 +257,50 @@ void VacuumSimulator::readHouseFile(const std::filesystem::path &fileInputpath)
         std::cerr << "Failed to parse house file: " << fileInputpath << std::endl;
         throw std::invalid_argument("Failed to parse house file");
     }
-    payload = std::move(parsedPayload);
+    setHouse(fileInputpath, std::move(parsedPayload));
+}
+/**
+ * The payload is never modified, every run works on its own copy so a parsed house can be shared between simulators
+ */
+void VacuumSimulator::setHouse(const std::filesystem::path &fileInputpath, std::shared_ptr<const VacuumPayload> payload)
+{
+    this->payload = std::move(payload);
     this->fileInputpath = fileInputpath;
     this->record = nullptr;
+    this->stepWriter = nullptr;
+    this->timedOut = false;
 }
 
-void VacuumSimulator::writeSummary(std::string houseName, std::filesystem::path path, std::string algorithmName,bool errored)
+std::optional<uint32_t> VacuumSimulator::getScore(bool errored)
 {
-    std::ifstream inFile(path);
-    std::ofstream outFile;
-    std::vector<std::string> houseNames;
-    std::vector<std::string> algorithmNames;
-    std::vector<std::vector<std::string>> tableData;
-    std::string line;
-
-    uint32_t score;
-    if(errored){
-        score = UINT32_MAX;
-    }
-    else{
-        score = VacuumScoreCalculator().calculateScore(record, timedOut);
-    }
-
-    if (inFile.is_open())
-    {
-        bool firstLine = true;
-        while (std::getline(inFile, line))
-        {
-            std::stringstream ss(line);
-            std::string cell;
-
-            if (firstLine)
-            {
-                while (std::getline(ss, cell, ','))
-                {
-                    if (!cell.empty())
-                    {
-                        houseNames.push_back(cell);
-                    }
-                }
-                firstLine = false;
-            }
-            else
-            {
-                std::vector<std::string> rowData;
-                bool hasData = false;
-
-                while (std::getline(ss, cell, ','))
-                {
-                    rowData.push_back(cell);
-                    if (!cell.empty())
-                    {
-                        hasData = true;
-                    }
-                }
-
-                if (hasData)
-                {
-                    algorithmNames.push_back(rowData[0]);
-                    tableData.push_back(rowData);
-                }
-            }
-        }
-        inFile.close();
-    }
-
-    bool newHouse = std::find(houseNames.begin(), houseNames.end(), houseName) == houseNames.end();
-    bool newAlgorithm = true;
-
-    size_t algoIndex = 0;
-    for (size_t i = 0; i < algorithmNames.size(); ++i)
-    {
-        if (algorithmNames[i] == algorithmName)
-        {
-            newAlgorithm = false;
-            algoIndex = i;
-            break;
-        }
-    }
-
-    if (newHouse)
-    {
-        houseNames.push_back(houseName);
-    }
-
-    if (newAlgorithm)
-    {
-        algorithmNames.push_back(algorithmName);
-        tableData.push_back(std::vector<std::string>(houseNames.size() + 1, "")); 
-        tableData.back()[0] = algorithmName; 
-        algoIndex = tableData.size() - 1;
-    }
-
-    size_t houseIndex = std::distance(houseNames.begin(), std::find(houseNames.begin(), houseNames.end(), houseName));
-
-    std::string scoreStr = std::to_string(score);
+    canExport();
     if (errored)
     {
-        scoreStr = "";
-    }
-    if (tableData[algoIndex].size() <= houseIndex + 1)
-    {
-        tableData[algoIndex].resize(houseIndex + 2, ""); 
-    }
-
-    tableData[algoIndex][houseIndex+1] = scoreStr;
-
-
-    outFile.open(path, std::ios_base::out | std::ios_base::trunc);
-
-    if (outFile.is_open())
-    {
-        houseNames.insert(houseNames.begin(), "");
-        for (const auto &house : houseNames)
-        {
-            outFile << house << ",";
-        }
-        outFile << "\n";
-
-        for (const auto &row : tableData)
-        {
-            for (const auto &cell : row)
-            {
-                outFile << cell << ",";
-            }
-            outFile << "\n";
-        }
-        outFile.close();
+        return std::nullopt;
     }
+    return VacuumScoreCalculator().calculateScore(record, timedOut);
 }
 
+uint32_t VacuumSimulator::getTimeoutScore() const
+{
+    return VacuumScoreCalculator().calculateTimeoutScore(payload->getMaxSteps(), payload->getHouse().getTotalDirt());
+}
 
 void VacuumSimulator::writeOutFile(std::ofstream &writeStream)
+{
+    writeOutHeader(writeStream);
+    writeStream << *record << std::endl;
+    writeStream.close();
+}
+void VacuumSimulator::writeOutHeader(std::ostream &writeStream)
 {
     auto recordLast = record->last();
-    auto inDock = recordLast->isAtDockingStation(); 
+    auto inDock = recordLast.isAtDockingStation(); 
     auto score = VacuumScoreCalculator().calculateScore(record, timedOut);
     writeStream << "NumSteps = " << record->size() << std::endl;
-    writeStream << "DirtLeft = " << recordLast->getDirtLevel() << std::endl;
+    writeStream << "DirtLeft = " << recordLast.getDirtLevel() << std::endl;
     writeStream << "Status = " << record->getStatus() << std::endl;
     writeStream << "InDock = " << (inDock ? "TRUE" : "FALSE") << std::endl;
     writeStream << "Score = " << score << std::endl;
-    writeStream << "Steps: \n"
-            << *record << std::endl;
-    writeStream.close();
-    
+    writeStream << "Steps: \n";
 }
\ No newline at end of file
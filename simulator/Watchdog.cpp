@@ -0,0 +1,129 @@
+#include "Watchdog.hpp"
+#include <algorithm>
+#include <pthread.h>
+#include <time.h>
+
+Watchdog::Watchdog()
+{
+    thread = std::thread(&Watchdog::watch, this);
+}
+Watchdog::~Watchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_one();
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+Watchdog::DeadlineId Watchdog::arm(Clock::time_point deadline, std::function<void()> onTimeout)
+{
+    return armRechecked(deadline, [onTimeout = std::move(onTimeout)]() -> std::optional<Clock::time_point> {
+        onTimeout();
+        return std::nullopt;
+    });
+}
+/**
+ * The limit is on the CPU time of the calling thread, time spent waiting for a core does not count.
+ * CPU time never runs ahead of wall time, so the thread is first looked at once limit has passed and then again
+ * once the rest of the limit could have been used. Wall time past backstop is a timeout whatever the CPU time is
+ */
+Watchdog::DeadlineId Watchdog::armCpuTime(Clock::duration limit, Clock::duration backstop, std::function<void()> onTimeout)
+{
+    auto start = Clock::now();
+    clockid_t cpuClock;
+    if (pthread_getcpuclockid(pthread_self(), &cpuClock) != 0)
+    {
+        return arm(start + limit, std::move(onTimeout));
+    }
+    auto readCpuTime = [cpuClock]() -> std::optional<Clock::duration> {
+        timespec time;
+        if (clock_gettime(cpuClock, &time) != 0)
+        {
+            return std::nullopt;
+        }
+        return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+    };
+    auto cpuStart = readCpuTime();
+    if (!cpuStart)
+    {
+        return arm(start + limit, std::move(onTimeout));
+    }
+    auto backstopDeadline = start + backstop;
+    return armRechecked(std::min<Clock::time_point>(start + limit, backstopDeadline), [=, onTimeout = std::move(onTimeout)]() -> std::optional<Clock::time_point> {
+        auto now = Clock::now();
+        // Once the clock can no longer be read (the thread is gone) the wall time used stands in for it
+        auto cpuNow = readCpuTime();
+        Clock::duration used = cpuNow ? *cpuNow - *cpuStart : now - start;
+        if (used >= limit || now >= backstopDeadline)
+        {
+            onTimeout();
+            return std::nullopt;
+        }
+        return std::min<Clock::time_point>(now + (limit - used), backstopDeadline);
+    });
+}
+Watchdog::DeadlineId Watchdog::armRechecked(Clock::time_point deadline, Check check)
+{
+    DeadlineId id;
+    bool isEarliest;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        isEarliest = deadlines.empty() || deadline < deadlines.top().first;
+        deadlines.emplace(deadline, id);
+        callbacks.emplace(id, std::move(check));
+    }
+    // Only an earlier deadline than the one the watchdog is sleeping on needs to wake it up
+    if (isEarliest)
+    {
+        changed.notify_one();
+    }
+    return id;
+}
+void Watchdog::disarm(DeadlineId id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    callbacks.erase(id);
+}
+std::size_t Watchdog::armedCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return callbacks.size();
+}
+void Watchdog::watch()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping)
+    {
+        if (deadlines.empty())
+        {
+            changed.wait(lock);
+            continue;
+        }
+        auto [deadline, id] = deadlines.top();
+        if (Clock::now() < deadline)
+        {
+            changed.wait_until(lock, deadline);
+            continue;
+        }
+        deadlines.pop();
+        auto callback = callbacks.find(id);
+        if (callback == callbacks.end())
+        {
+            continue;
+        }
+        auto next = callback->second();
+        if (next)
+        {
+            deadlines.emplace(*next, id);
+        }
+        else
+        {
+            callbacks.erase(callback);
+        }
+    }
+}
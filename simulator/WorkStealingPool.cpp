@@ -0,0 +1,117 @@
+#include "WorkStealingPool.hpp"
+#include <iostream>
+
+WorkStealingPool::WorkStealingPool(std::size_t numWorkers)
+{
+    if (numWorkers == 0)
+    {
+        numWorkers = 1;
+    }
+    for (std::size_t i = 0; i < numWorkers; i++)
+    {
+        workers.emplace_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < numWorkers; i++)
+    {
+        threads.emplace_back(&WorkStealingPool::work, this, i);
+    }
+}
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    jobQueued.notify_all();
+    for (auto &thread : threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+void WorkStealingPool::submit(Job job)
+{
+    auto &worker = *workers[nextWorker++ % workers.size()];
+    // Counted before it is queued, a worker may take and finish the job before this returns
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queuedJobs++;
+        pendingJobs++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+    }
+    jobQueued.notify_one();
+}
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this]() { return pendingJobs == 0; });
+}
+bool WorkStealingPool::tryTake(std::size_t self, Job &job)
+{
+    for (std::size_t i = 0; i < workers.size(); i++)
+    {
+        auto &worker = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.jobs.empty())
+        {
+            continue;
+        }
+        // Stealing from the back leaves the owner the jobs it is about to run
+        if (i == 0)
+        {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+        }
+        else
+        {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+void WorkStealingPool::work(std::size_t self)
+{
+    while (true)
+    {
+        Job job;
+        if (!tryTake(self, job))
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            if (stopping && queuedJobs == 0)
+            {
+                return;
+            }
+            jobQueued.wait(lock, [this]() { return queuedJobs > 0 || stopping; });
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            queuedJobs--;
+        }
+        try
+        {
+            job();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: Unhandled exception in worker " << e.what() << std::endl;
+        }
+        bool isLast;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            isLast = --pendingJobs == 0;
+        }
+        if (isLast)
+        {
+            allDone.notify_all();
+        }
+    }
+}
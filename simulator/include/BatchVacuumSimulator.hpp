@@ -1,27 +1,30 @@
 #pragma once
 #include "SimulationArguments.hpp"
-#include <thread>
-#include <utility>
-#include <condition_variable>
-#include <mutex>
-class Task
+#include "HouseCache.hpp"
+#include "MemoryBudget.hpp"
+#include "OutputWriter.hpp"
+#include "ProcessPool.hpp"
+#include "SummaryTable.hpp"
+#include "TaskScheduler.hpp"
+#include "Watchdog.hpp"
+#include "WorkStealingPool.hpp"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+class VacuumSimulator;
+/**
+ * What a simulation needs from the batch running it, the threaded batch and its worker processes fill it differently
+ */
+class SimulationContext
 {
     public:
-        Task(std::thread &&thread,char* monitor) : threadfd(std::move(thread)),isDone(monitor) {}
-        char getMonitor() { return *isDone; }
-        void resetMonitor() { if (isDone != nullptr) {*isDone = 0;} }
-        auto& getThread() { return threadfd; }
-        ~Task() {
-            if(threadfd.joinable())
-            {
-                threadfd.join(); 
-            }
-            resetMonitor();
-        }
-    private:
-        std::thread threadfd;
-        char* isDone;
-
+        OutputWriter &output;
+        HouseCache &houseCache;
+        Watchdog &watchdog;
+        std::function<void(const std::string &algorithmName, const std::string &houseName, std::optional<uint32_t> score)> reportScore;
+        std::function<void(const std::string &algorithmName, const VacuumSimulator &simulator)> onStart = nullptr;
+        std::function<void(const VacuumSimulator &simulator)> onStop = nullptr;
 };
 class BatchVacuumSimulator
 {
@@ -29,18 +32,28 @@ class BatchVacuumSimulator
         void run(const SimulationArguments &args);
         inline static const std::filesystem::path CWD = std::filesystem::current_path();
         ~BatchVacuumSimulator();
+        constexpr static auto HARD_TIMEOUT_GRACE = std::chrono::seconds(1);
+        /**
+         * With cpu_time, how many times the time limit a run may take in wall time before it is timed out anyway
+         */
+        constexpr static int WALL_TIME_BACKSTOP = 4;
+        friend class BatchVacuumSimulatorTest;
     private:
         void reserveHandles(const std::vector<std::filesystem::path> & algorithmFiles);
-        void enqueueTask(const SimulationArguments &args, const std::filesystem::path &houseFile, auto &algorithm);
-        void discardFinishedThreads();
+        void enqueueTask(const SimulationArguments &args);
+        void runTask(const SimulationArguments &args, const std::filesystem::path &houseFile, const auto &algorithm, SimulationContext &context);
+        void runIsolated(const SimulationArguments &args);
         void clearHandles();
 
     private:
-        std::vector<std::unique_ptr<Task>> tasks;
-        std::vector<std::thread> threadPool;
-        std::mutex summaryMutex;
         std::vector<void *> handles;
-        std::shared_ptr<std::counting_semaphore<>> semaphore;
+        std::unique_ptr<HouseCache> houseCache;
+        std::unique_ptr<Watchdog> watchdog;
+        std::unique_ptr<WorkStealingPool> pool;
+        std::unique_ptr<SummaryTable> summary;
+        std::unique_ptr<TaskScheduler> scheduler;
+        std::unique_ptr<MemoryBudget> memoryBudget;
+        std::unique_ptr<OutputWriter> output;
 
 
 };
\ No newline at end of file
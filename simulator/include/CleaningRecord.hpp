@@ -1,7 +1,9 @@
 #pragma once
 #include "CleaningRecordStep.hpp"
+#include "MeteredVacuumBattery.hpp"
 #include <vector>
 #include <memory>
+#include <optional>
 #include <string>
 enum class Status{
     DEAD,
@@ -19,25 +21,66 @@ inline std::ostream& operator<<(std::ostream& os, const Status& step) {
 }
 class CleaningRecord {
 public:
-    CleaningRecord(const CleaningRecordStep& initialStep, uint32_t maxSteps);
-    void add(CleaningRecordStep step);
-    const std::shared_ptr<CleaningRecordStep> getInitialStep() const;
-    const std::shared_ptr<CleaningRecordStep> last() const;
+    CleaningRecord(const CleaningRecordStep& initialStep, uint32_t maxSteps, bool keepHistory = true);
+    void add(const CleaningRecordStep& step);
+    void addCharging(const CleaningRecordStep& lastStep, uint32_t count, const MeteredVacuumBattery& batteryBefore);
+    std::optional<CleaningRecordStep> getInitialStep() const;
+    CleaningRecordStep last() const;
     uint32_t size() const;
-    const std::shared_ptr<CleaningRecordStep> operator[](std::size_t idx);
+    CleaningRecordStep operator[](std::size_t idx) const;
     uint32_t getMaxSteps() const { return maxSteps; }
     Status getStatus() const;
     friend std::ostream& operator<<(std::ostream& os, const CleaningRecord& record);
-    uint32_t getInitialDirt();
+    uint32_t getInitialDirt() const;
+    bool isKeepingHistory() const { return keepHistory; }
     
 private:
+    /**
+     * Never reserve more than this up front, houses may declare a MaxSteps far larger than any run actually takes
+     */
+    constexpr static std::size_t MAX_RESERVED_STEPS = 1 << 20;
     bool hasInitialStep;
     uint32_t maxSteps;
     std::string algorithmName;
-    std::vector<std::shared_ptr<CleaningRecordStep>> steps;
+    /**
+     * Without history only the latest step is kept, which is all the score needs
+     */
+    bool keepHistory;
+    uint32_t recordedSteps = 0;
+    /**
+     * The dirt of the house the run started on, known even when the run timed out before recording a step
+     */
+    uint32_t initialDirt = 0;
+    /**
+     * Steps are kept as parallel arrays, the step and the location type are packed into a single byte
+     */
+    std::vector<uint8_t> moves;
+    std::vector<uint32_t> batteryLevels;
+    std::vector<uint32_t> dirtLevels;
+    /**
+     * A run of Stay steps on the charging station is stored as a single entry, the battery of each step in the run
+     * is recomputed from the battery as it was before the run
+     */
+    struct ChargingRun {
+        std::size_t firstStep;
+        std::size_t entry;
+        uint32_t count;
+        MeteredVacuumBattery batteryBefore;
+    };
+    std::vector<ChargingRun> chargingRuns;
 private:
-    bool isDead() const { return size() != 0 && last()->getBatteryLevel() == 0 && !last()->isAtDockingStation(); } 
-    bool isFinished() const { return last()->getStep() == Step::Finish;} 
+    bool isDead() const { return size() != 0 && last().getBatteryLevel() == 0 && !last().isAtDockingStation(); } 
+    bool isFinished() const { return last().getStep() == Step::Finish;} 
     bool isAtMaxSteps() const { return size() == getMaxSteps(); } 
+    CleaningRecordStep getStoredStep(std::size_t idx) const;
+    CleaningRecordStep getEntry(std::size_t entry) const;
+    void startStep();
+    void push(const CleaningRecordStep& step);
+    void clear();
+    static uint8_t pack(LocationType locationType, Step step);
+    static LocationType unpackLocationType(uint8_t move);
+    static Step unpackStep(uint8_t move) { return static_cast<Step>(move & STEP_MASK); }
+    constexpr static uint8_t STEP_MASK = 0x7;
+    constexpr static uint8_t LOCATION_TYPE_SHIFT = 3;
 
 };
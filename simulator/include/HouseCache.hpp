@@ -0,0 +1,38 @@
+#pragma once
+#include "VacuumPayload.hpp"
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+/**
+ * Parses every house file once for the whole batch, all the algorithms running on a house share the same immutable payload.
+ * A house is dropped from the cache once it has been handed out or released usesPerHouse times
+ */
+class HouseCache
+{
+    public:
+        HouseCache(uint32_t usesPerHouse) : usesPerHouse(usesPerHouse) {};
+        std::shared_ptr<const VacuumPayload> acquire(const std::filesystem::path &houseFile);
+        /**
+         * Gives up a use of the house without parsing it, for a run that failed before it needed the house
+         */
+        void release(const std::filesystem::path &houseFile);
+        std::size_t size();
+    private:
+        class Entry
+        {
+            public:
+                Entry(std::shared_future<std::shared_ptr<const VacuumPayload>> payload, uint32_t remainingUses) : payload(payload), remainingUses(remainingUses) {};
+                /**
+                 * Not valid while the house was only released so far, the first acquire parses it
+                 */
+                std::shared_future<std::shared_ptr<const VacuumPayload>> payload;
+                uint32_t remainingUses;
+        };
+        std::mutex mutex;
+        void useLocked(std::unordered_map<std::string, Entry>::iterator entry);
+        std::unordered_map<std::string, Entry> entries;
+        uint32_t usesPerHouse;
+};
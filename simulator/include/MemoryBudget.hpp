@@ -0,0 +1,57 @@
+#pragma once
+#include "VacuumParser.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+/**
+ * Admits simulations against a memory budget for the whole batch. Each run reserves what its house header says it will
+ * need, and the estimates are scaled by how much the resident size of the process grows over them while runs are in flight.
+ * A run is always admitted when nothing else is running, so a house larger than the budget still runs, alone
+ */
+class MemoryBudget
+{
+    public:
+        class Reservation
+        {
+            public:
+                Reservation() = default;
+                Reservation(MemoryBudget *budget, std::size_t bytes) : budget(budget), bytes(bytes) {};
+                Reservation(Reservation &&other) noexcept : budget(std::exchange(other.budget, nullptr)), bytes(other.bytes) {};
+                Reservation &operator=(Reservation &&other) noexcept;
+                ~Reservation();
+            private:
+                MemoryBudget *budget = nullptr;
+                std::size_t bytes = 0;
+        };
+        MemoryBudget(std::size_t budgetBytes);
+        Reservation reserve(std::size_t estimatedBytes);
+        static std::size_t estimate(const HouseHeader &header, bool keepHistory);
+        static std::size_t readResidentBytes();
+        std::size_t getReservedBytes();
+        double getScale();
+        constexpr static std::size_t BYTES_PER_TILE = 16;
+        /**
+         * What a mapping algorithm keeps for each tile it has seen, the house cannot know it but this is its typical size
+         */
+        constexpr static std::size_t ALGORITHM_BYTES_PER_TILE = 96;
+        constexpr static std::size_t BYTES_PER_STEP = 16;
+        constexpr static std::size_t BYTES_PER_RUN = 64 * 1024;
+        constexpr static auto RECHECK_INTERVAL = std::chrono::milliseconds(50);
+        constexpr static double MIN_SCALE = 0.5;
+        constexpr static double MAX_SCALE = 4;
+    private:
+        void release(std::size_t bytes);
+        void measure();
+        std::size_t budget;
+        /**
+         * The resident size when the last run was admitted with nothing else in flight
+         */
+        std::size_t baseline = 0;
+        std::size_t reserved = 0;
+        std::size_t inFlight = 0;
+        double scale = 1;
+        std::mutex mutex;
+        std::condition_variable released;
+};
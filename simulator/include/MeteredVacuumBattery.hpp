@@ -1,18 +1,25 @@
 #pragma once
-#include "BatteryMeter.h"
+#include "ChargingBatteryMeter.h"
 #include <cstdint>
-class MeteredVacuumBattery : public BatteryMeter
+class MeteredVacuumBattery : public ChargingBatteryMeter
 {
     public:
-        MeteredVacuumBattery(uint32_t batterySteps,uint32_t maxBatterySteps) : batteryLevel(batterySteps), maxBatterySteps(maxBatterySteps) {};
+        MeteredVacuumBattery(uint32_t batterySteps,uint32_t maxBatterySteps) : batteryLevel(static_cast<uint64_t>(batterySteps) * CHARGE_STEPS_TO_FULL), maxBatterySteps(maxBatterySteps) {};
         void charge(uint32_t steps = 1);
         bool try_activate(uint32_t steps = 1);
-        std::size_t getBatteryState() const override {return getCompensatedBatteryLevel();};
-        uint32_t getMaxBatterySteps() {return maxBatterySteps;};
+        std::size_t getBatteryState() const override {return batteryLevel / CHARGE_STEPS_TO_FULL;};
+        std::size_t getMaxBatteryState() const override {return maxBatterySteps;};
+        std::size_t getBatteryStateAfterCharging(std::size_t chargeSteps) const override {return getLevelAfterCharging(chargeSteps) / CHARGE_STEPS_TO_FULL;};
+        std::optional<std::size_t> getChargeStepsToReach(std::size_t batteryState) const override;
+        uint32_t getMaxBatterySteps() const {return maxBatterySteps;};
+        constexpr static uint32_t CHARGE_STEPS_TO_FULL = 20;
     private:
-        constexpr static double DOUBLE_INACCURACY_COMPENSATION = 1e-9;
-        double getCompensatedBatteryLevel() const {return batteryLevel + DOUBLE_INACCURACY_COMPENSATION;};
-        double calculateNewBatteryLevel(uint32_t steps);
-        double batteryLevel;
+        /**
+         * The level is kept in units of 1/20 of a step so a charge step, which adds maxBatterySteps/20 steps,
+         * is always a whole number of units and the level never drifts
+         */
+        uint64_t getLevelAfterCharging(uint64_t steps) const;
+        uint64_t getMaxLevel() const {return static_cast<uint64_t>(maxBatterySteps) * CHARGE_STEPS_TO_FULL;};
+        uint64_t batteryLevel;
         uint32_t maxBatterySteps;
-};
\ No newline at end of file
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+/**
+ * A dedicated thread for the per run output files, simulation threads queue what to write and move on.
+ * Files are written one at a time through a single reused buffer so each one goes out in a few large writes
+ */
+class OutputWriter
+{
+    public:
+        using Formatter = std::function<void(std::ostream &)>;
+        using ErrorHandler = std::function<void(const std::string &)>;
+        OutputWriter();
+        ~OutputWriter();
+        OutputWriter(const OutputWriter &) = delete;
+        OutputWriter &operator=(const OutputWriter &) = delete;
+        void write(const std::filesystem::path &path, Formatter formatter, ErrorHandler onError = nullptr);
+        void submit(std::function<void()> job, ErrorHandler onError = nullptr);
+        void flush();
+        constexpr static std::size_t BUFFER_SIZE = 1 << 20;
+    private:
+        class Job
+        {
+            public:
+                std::function<void()> work;
+                ErrorHandler onError;
+        };
+        void run();
+        void writeFile(const std::filesystem::path &path, const Formatter &formatter);
+        std::vector<char> buffer;
+        std::deque<Job> jobs;
+        bool busy = false;
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable jobQueued;
+        std::condition_variable drained;
+        std::thread thread;
+};
@@ -4,8 +4,8 @@
 class PlacedHouse : public House
 {
     public: 
-        virtual HouseLocation& getCurrentLocation() = 0;
-        virtual HouseLocation& getDirectionLocation(const Direction& direction) = 0;
+        virtual HouseLocation getCurrentLocation() const = 0;
+        virtual HouseLocation getDirectionLocation(const Direction& direction) const = 0;
         virtual bool is_move(const Direction& direction) = 0;
         virtual void move(const Direction& direction) = 0;
         virtual ~PlacedHouse() {};
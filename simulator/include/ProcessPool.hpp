@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+/**
+ * A fixed set of pre-forked worker processes, tasks are handed to them by index and each returns a string result.
+ * A task that knows how long it may take sets a time limit, a worker still on the task past that limit is killed
+ * with SIGKILL and replaced so a stuck task never keeps a core busy. Workers are forked from the thread calling run,
+ * which must be the only thread of the process while the pool is in use
+ */
+class ProcessPool
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+        enum class Outcome { Finished, TimedOut, Crashed };
+        /**
+         * Lets a running task talk to the pool, resultIfKilled is reported for the task if its worker does not finish it
+         */
+        class TaskControl
+        {
+            public:
+                TaskControl(int fd) : fd(fd) {};
+                void setTimeLimit(Clock::duration limit, const std::string &resultIfKilled) const;
+                void clearTimeLimit() const;
+            private:
+                int fd;
+        };
+        using Task = std::function<std::string(std::size_t task, const TaskControl &control)>;
+        using ResultHandler = std::function<void(std::size_t task, Outcome outcome, const std::string &result)>;
+        using GroupOf = std::function<std::size_t(std::size_t task)>;
+        ProcessPool(std::size_t numWorkers, Task task);
+        ~ProcessPool();
+        ProcessPool(const ProcessPool &) = delete;
+        ProcessPool &operator=(const ProcessPool &) = delete;
+        /**
+         * Tasks of the same group, which must be contiguous, stay on the worker that started the group while it has tasks
+         * left, so whatever the worker kept from one is there for the next. A worker only takes tasks of a group another
+         * one started once every group was started. Without groups the tasks are handed out in index order
+         */
+        void run(std::size_t taskCount, const ResultHandler &onResult, const GroupOf &groupOf = nullptr);
+        std::size_t size() const { return workers.size(); };
+    private:
+        class Worker
+        {
+            public:
+                pid_t pid = -1;
+                int fd = -1;
+                std::optional<std::size_t> task;
+                std::optional<Clock::time_point> deadline;
+                std::string resultIfKilled;
+                std::optional<std::size_t> group;
+        };
+        class Group
+        {
+            public:
+                std::size_t next;
+                std::size_t end;
+        };
+        void spawn(std::size_t index);
+        void stop(Worker &worker, bool kill);
+        [[noreturn]] void serve(int fd);
+        bool receive(Worker &worker, std::optional<std::string> &result);
+        std::vector<Worker> workers;
+        Task task;
+};
@@ -10,11 +10,11 @@ class VacuumScoreCalculator : public ScoreCalculator
 public:
     int calculateScore(const std::shared_ptr<CleaningRecord> record, bool timedOut) override
     {
-        uint32_t dirtScore = record->last()->getDirtLevel() * 300; 
-        bool inDock = record->last()->isAtDockingStation();
+        uint32_t dirtScore = record->last().getDirtLevel() * 300; 
+        bool inDock = record->last().isAtDockingStation();
         auto status = record->getStatus();
         if(timedOut){
-            return record->getMaxSteps() * 2 + record->getInitialDirt() * 300 + 2000;
+            return calculateTimeoutScore(record->getMaxSteps(), record->getInitialDirt());
         }
         if (status == Status::DEAD)
         {
@@ -26,4 +26,11 @@ public:
         }
         return record->size() + dirtScore + (inDock ? 0 : 1000);
     }
+    /**
+     * A timed out run scores the same whatever it did, so the score is known before the run starts
+     */
+    int calculateTimeoutScore(uint32_t maxSteps, uint32_t initialDirt)
+    {
+        return maxSteps * 2 + initialDirt * 300 + 2000;
+    }
 };
\ No newline at end of file
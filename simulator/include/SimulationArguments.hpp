@@ -8,16 +8,27 @@ public:
     SimulationArguments(int argc, char** argv);
     bool isHelp() const;
     bool isSummaryOnly() const { return summaryOnly; }
+    bool isStreamOutput() const { return streamOutput; }
+    bool isIsolated() const { return isolated; }
+    bool isCpuTime() const { return cpuTime; }
     const std::vector<std::filesystem::path> & getHouseFiles() const { return houseFiles; }
     const std::vector<std::filesystem::path> & getAlgorithmFiles() const { return algoFiles; }
     uint32_t getNumThreads() const { return numThreads; }
+    std::size_t getMemoryBudget() const { return memoryBudget; }
 private:
     bool hasFlag(const std::string& flag) const;
     bool isValidDirectory(const std::string& pathStr);
     bool summaryOnly = false;
+    bool streamOutput = false;
+    bool isolated = false;
+    bool cpuTime = false;
     std::vector<std::filesystem::path> houseFiles;
     std::vector<std::filesystem::path> algoFiles;
     uint32_t numThreads = 10;
+    /**
+     * In bytes, 0 for no budget
+     */
+    std::size_t memoryBudget = 0;
 
 
 };
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include "enums.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <vector>
+/**
+ * Spools the steps of a run to disk while it is simulated, the out file header is only known once the run is over
+ * so finalize writes it and then appends the spooled steps behind it
+ */
+class StepStreamWriter
+{
+    public:
+        StepStreamWriter(const std::filesystem::path &outputPath);
+        ~StepStreamWriter();
+        void write(Step step, std::size_t count = 1);
+        std::filesystem::path finalize(const std::function<void(std::ostream &)> &writeHeader);
+        constexpr static std::size_t BUFFER_SIZE = 1 << 16;
+    private:
+        std::filesystem::path outputPath;
+        std::filesystem::path spoolPath;
+        std::vector<char> buffer;
+        std::ofstream spool;
+        std::mutex mutex;
+        bool finalized = false;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/**
+ * The algorithm x house score matrix of summary.csv, kept in memory so the file is read once and written once.
+ * Scores already in the file when the table is loaded are kept, a missing score is written as an empty cell
+ */
+class SummaryTable
+{
+    public:
+        SummaryTable(const std::filesystem::path &path);
+        void set(const std::string &algorithmName, const std::string &houseName, std::optional<uint32_t> score);
+        void write();
+        bool isChanged();
+    private:
+        void load();
+        std::size_t getHouseIndex(const std::string &houseName);
+        std::size_t getAlgorithmIndex(const std::string &algorithmName);
+        std::filesystem::path path;
+        std::vector<std::string> houseNames;
+        std::unordered_map<std::string, std::size_t> houseIndices;
+        std::unordered_map<std::string, std::size_t> algorithmIndices;
+        /**
+         * One row per algorithm, the first cell is the algorithm name
+         */
+        std::vector<std::vector<std::string>> tableData;
+        bool changed = false;
+        std::mutex mutex;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include "VacuumParser.hpp"
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <vector>
+/**
+ * Hands out the simulations of a batch house by house, the house with the longest expected run first, so no long run is
+ * left to start once the others are done. All the runs of a house are handed out before the next house is started, so
+ * a parsed house leaves the HouseCache as soon as possible. The cost of a run is estimated from its house header and
+ * per algorithm statistics learned from the runs finished so far: how many steps it takes per tile of the house, bounded
+ * by MaxSteps, and how long a step takes. Houses too small to matter go first through a fast lane
+ */
+class TaskScheduler
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+        class Task
+        {
+            public:
+                std::filesystem::path houseFile;
+                std::size_t algorithm;
+                std::optional<HouseHeader> header;
+        };
+        TaskScheduler(std::size_t algorithmCount, std::size_t numWorkers);
+        /**
+         * Queues a run of every algorithm on the house
+         */
+        void add(const std::filesystem::path &houseFile, std::optional<HouseHeader> header);
+        Clock::duration start();
+        std::optional<Task> next();
+        void finished(const Task &task, Clock::duration elapsed, std::size_t steps);
+        Clock::duration estimate(const Task &task);
+        constexpr static std::chrono::nanoseconds PRIOR_TIME_PER_STEP = std::chrono::microseconds(10);
+        constexpr static double PRIOR_STEPS_PER_TILE = 4;
+        constexpr static std::chrono::nanoseconds TIME_PER_TILE = std::chrono::nanoseconds(100);
+        constexpr static std::chrono::nanoseconds FAST_LANE_LIMIT = std::chrono::milliseconds(1);
+        /**
+         * How many steps worth of runs the prior time per step counts for against the learned one
+         */
+        constexpr static double PRIOR_WEIGHT_STEPS = 10000;
+        /**
+         * How many tiles worth of runs the prior steps per tile counts for against the learned one
+         */
+        constexpr static double PRIOR_WEIGHT_TILES = 1000;
+    private:
+        class House
+        {
+            public:
+                std::filesystem::path houseFile;
+                std::optional<HouseHeader> header;
+                /**
+                 * The algorithms yet to run on the house, once it is started the longest run is last
+                 */
+                std::vector<std::size_t> algorithms;
+        };
+        /**
+         * A slow lane house by its cost under the ranking statistics
+         */
+        class QueuedHouse
+        {
+            public:
+                Clock::duration cost;
+                std::size_t house;
+                bool operator<(const QueuedHouse &other) const { return cost < other.cost; };
+        };
+        class AlgorithmStats
+        {
+            public:
+                double stepSeconds = 0;
+                double steps = 0;
+                double tiles = 0;
+        };
+        Clock::duration estimateLocked(const Task &task, const std::vector<AlgorithmStats> &stats) const;
+        Clock::duration houseCostLocked(const House &house) const;
+        void openLocked(House house);
+        void rerankLocked();
+        std::vector<AlgorithmStats> algorithms;
+        /**
+         * What the slow lane is ranked by, taken from the learned statistics each time the number of finished runs doubles,
+         * so the slow lane is only costed again a logarithmic number of times over the batch
+         */
+        std::vector<AlgorithmStats> rankingStats;
+        bool rankingChanged = false;
+        std::size_t finishedRuns = 0;
+        std::vector<House> houses;
+        std::priority_queue<QueuedHouse> slowLane;
+        std::vector<House> fastLane;
+        std::optional<House> openHouse;
+        std::size_t numWorkers;
+        std::mutex mutex;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "HouseLocation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+/**
+ * Sparse copy on write layer over an immutable grid of tiles, keyed by the tile index.
+ * Open addressing with linear probing, an empty overlay allocates nothing so copying it is free.
+ * References returned by find and emplace are only valid until the next emplace
+ */
+class TileOverlay
+{
+    public:
+        const HouseLocation *find(size_t index) const
+        {
+            if (slots.empty()) {
+                return nullptr;
+            }
+            const auto &slot = slots[probe(index)];
+            return slot.first == index ? &slot.second : nullptr;
+        }
+        HouseLocation *find(size_t index)
+        {
+            return const_cast<HouseLocation *>(static_cast<const TileOverlay *>(this)->find(index));
+        }
+        HouseLocation &emplace(size_t index, const HouseLocation &location)
+        {
+            if ((count + 1) * 2 > slots.size()) {
+                grow();
+            }
+            auto &slot = slots[probe(index)];
+            if (slot.first != index) {
+                slot = {index, location};
+                count++;
+            }
+            return slot.second;
+        }
+        size_t size() const { return count; }
+
+    private:
+        constexpr static size_t EMPTY_SLOT = SIZE_MAX;
+        constexpr static size_t INITIAL_CAPACITY = 16;
+        std::vector<std::pair<size_t, HouseLocation>> slots;
+        size_t count = 0;
+
+        size_t probe(size_t index) const
+        {
+            size_t mask = slots.size() - 1;
+            size_t slot = (index * 0x9E3779B97F4A7C15ULL) & mask;
+            while (slots[slot].first != EMPTY_SLOT && slots[slot].first != index) {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+        void grow()
+        {
+            auto previousSlots = std::move(slots);
+            slots.assign(previousSlots.empty() ? INITIAL_CAPACITY : previousSlots.size() * 2, {EMPTY_SLOT, HouseLocation(LocationType::WALL)});
+            for (const auto &slot : previousSlots) {
+                if (slot.first != EMPTY_SLOT) {
+                    slots[probe(slot.first)] = slot;
+                }
+            }
+        }
+};
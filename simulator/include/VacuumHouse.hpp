@@ -5,17 +5,22 @@
 #include "WallSensor.h"
 #include "BatteryMeter.h"
 #include "enums.h"
+#include "TileOverlay.hpp"
+#include <memory>
 class VacuumHouse : public PlacedHouse , public DirtSensor, public WallsSensor
 {
     public:
         VacuumHouse(const std::vector<std::string>& locations,uint32_t rows,uint32_t cols);
         ~VacuumHouse() override { };
-        uint32_t getTotalDirt() const override;
-        HouseLocation &getCurrentLocation() override;
-        const HouseLocation &getCurrentLocation() const;
-        HouseLocation &getDirectionLocation(const Direction &direction) override;
-        const HouseLocation &getDirectionLocation(const Direction &direction) const;
-        HouseLocation &getStepLocation(const Step &step);
+        uint32_t getTotalDirt() const override { return totalDirt; };
+        uint32_t getDirtyTileCount() const { return dirtyTileCount; };
+        uint32_t getRowBandDirt(size_t band) const;
+        size_t getRowBandCount() const { return layout->rowBandDirt.size(); };
+        /**
+         * Tiles are read by value, dirt only ever changes through cleanCurrentLocation
+         */
+        HouseLocation getCurrentLocation() const override { return getTile(currentLocation); };
+        HouseLocation getDirectionLocation(const Direction &direction) const override;
         void cleanCurrentLocation();
         bool is_move(const Step & step);
         bool is_move(const Direction &direction) override;
@@ -23,17 +28,54 @@ class VacuumHouse : public PlacedHouse , public DirtSensor, public WallsSensor
         void move(const Direction &direction) override;
 
 
-        bool isWall(Direction d) const override { return getDirectionLocation(d).getLocationType() == LocationType::WALL; };
-        int dirtLevel() const override { return getCurrentLocation().getDirtLevel(); };
+        bool isWall(Direction d) const override { return layout->wallMasks[currentLocation] & getWallBit(d); };
+        int dirtLevel() const override { return getTile(currentLocation).getDirtLevel(); };
+        uint8_t getWallMask() const { return layout->wallMasks[currentLocation]; };
 
         friend std::ostream &operator<<(std::ostream &os, const VacuumHouse &house);
+        constexpr static size_t ROW_BAND_HEIGHT = 16;
     private:
-        Coordinate<size_t> currentLocation;
-        std::vector<std::vector<HouseLocation>> houseLocations;
-        HouseLocation logicalWall;
-        const HouseLocation* chargingStation;
+        /**
+         * Everything about the house that a run never changes, shared by every copy of the house.
+         * The house is stored row major with a one tile wall border around it, so every neighbour of a
+         * house tile is a fixed offset away and never out of bounds
+         */
+        class Layout
+        {
+            public:
+                size_t rows;
+                size_t cols;
+                std::vector<HouseLocation> houseLocations;
+                /**
+                 * Walls never change during a run, so each tile keeps a bit per direction telling whether its neighbour is a wall
+                 */
+                std::vector<uint8_t> wallMasks;
+                size_t chargingStation;
+                uint32_t totalDirt = 0;
+                uint32_t dirtyTileCount = 0;
+                std::vector<uint32_t> rowBandDirt;
+        };
+        std::shared_ptr<const Layout> layout;
+        /**
+         * Per run state, only the tiles that were cleaned are copied out of the layout
+         */
+        size_t currentLocation;
+        TileOverlay cleanedTiles;
+        uint32_t totalDirt = 0;
+        uint32_t dirtyTileCount = 0;
+        std::vector<uint32_t> rowBandDirt;
 
     private:
-        std::vector<std::vector<HouseLocation>> constructHouseLocation(const std::vector<std::string> &locations, uint32_t rows, uint32_t cols);
-        bool inBounds(Coordinate<size_t> &coordinate) const;
+        static std::vector<HouseLocation> constructHouseLocation(const std::vector<std::string> &locations, uint32_t rows, uint32_t cols);
+        static std::vector<uint8_t> constructWallMasks(const Layout &layout);
+        static void accumulateDirt(Layout &layout);
+        static size_t getStride(const Layout &layout) { return layout.cols + 2; };
+        static std::ptrdiff_t getStepOffset(const Layout &layout, const Step &step);
+        size_t getStride() const { return getStride(*layout); };
+        size_t getRow(size_t index) const { return index / getStride() - 1; };
+        std::ptrdiff_t getStepOffset(const Step &step) const { return getStepOffset(*layout, step); };
+        constexpr static uint8_t getWallBit(Direction direction) { return 1 << static_cast<uint8_t>(direction); };
+        const HouseLocation &getTile(size_t index) const;
+        HouseLocation &getMutableTile(size_t index);
+        void setDirtLevel(HouseLocation &location, size_t row, uint8_t dirtLevel);
 };
\ No newline at end of file
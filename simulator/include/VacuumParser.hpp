@@ -3,11 +3,24 @@
 #include <string>
 #include <filesystem>
 #include <memory>
+#include <optional>
+/**
+ * The numbers at the top of a house file, enough to tell how expensive a house is without reading its layout
+ */
+class HouseHeader
+{
+    public:
+        uint32_t maxSteps;
+        uint32_t maxBattery;
+        uint32_t rows;
+        uint32_t cols;
+};
 class VacuumParser
 {
     public:
         VacuumParser() { };
         std::unique_ptr<VacuumPayload> parse(const std::filesystem::path& fileInputpath);
+        std::optional<HouseHeader> parseHeader(const std::filesystem::path& fileInputpath);
         private:
             std::vector<std::string> readlines(const std::filesystem::path& fileInputpath);
             std::optional<uint32_t> parseNumberFromLine(const std::string& line, const std::string& name);
@@ -1,15 +1,19 @@
 #pragma once
 #include "VacuumHouse.hpp"
 #include "MeteredVacuumBattery.hpp"
+#include "SensorSnapshot.h"
 #include <chrono>
-class VacuumPayload {
+class VacuumPayload : public SensorSnapshot {
     public:
         VacuumPayload(VacuumHouse house ,MeteredVacuumBattery battery,uint32_t maxSteps):
             house(house),battery(battery),maxSteps(maxSteps) {};
         VacuumHouse& getHouse() {return house;}
+        const VacuumHouse& getHouse() const {return house;}
         MeteredVacuumBattery& getBattery() {return battery;}
+        const MeteredVacuumBattery& getBattery() const {return battery;}
         uint32_t getMaxSteps() const {return maxSteps;}
         auto getMaxTime() const { return std::chrono::milliseconds(maxSteps) * 5 + std::chrono::milliseconds(100); }
+        SensorReadings getSensorReadings() const override { return SensorReadings{house.getWallMask(), house.dirtLevel(), battery.getBatteryState()}; }
 
     private:
         VacuumHouse house;
@@ -3,6 +3,9 @@
 #include "VacuumPayload.hpp"
 #include "AbstractAlgorithm.h"
 #include "Simulator.hpp"
+#include "StepStreamWriter.hpp"
+#include "OutputWriter.hpp"
+#include <atomic>
 #include <filesystem>
 #include <memory>
 
@@ -13,25 +16,38 @@ public:
     void run() override;
     void setAlgorithm(std::unique_ptr<AbstractAlgorithm> algorithm);
     void readHouseFile(const std::filesystem::path &fileInputpath);
+    void setHouse(const std::filesystem::path &fileInputpath, std::shared_ptr<const VacuumPayload> payload);
     auto getMaxTime() const { return payload->getMaxTime(); }
     void timeout() { timedOut = true; };
+    bool isTimedOut() const { return timedOut; };
+    void setKeepHistory(bool keepHistory) { this->keepHistory = keepHistory; };
+    void streamRecord(std::string algorithmName);
     std::filesystem::path exportRecord(std::string algorithmName);
+    std::filesystem::path exportRecord(std::string algorithmName, OutputWriter &output, OutputWriter::ErrorHandler onError);
     std::filesystem::path exportSummary(std::string algorithmName,bool errored);
+    std::optional<uint32_t> getScore(bool errored);
+    uint32_t getTimeoutScore() const;
+    uint32_t getStepsTaken() const { return record ? record->size() : 0; };
+    std::string getHouseName() const { return fileInputpath.stem().string(); };
     friend class SpecificAlgorithmTest;
     friend class VacuumSimulatorTest;
 private:
     std::optional<CleaningRecordStep> applyStep(VacuumPayload &payload, Step step);
+    bool takeStep(VacuumPayload &runPayload, Step step);
+    void fastForwardCharging(VacuumPayload &payload);
     std::shared_ptr<CleaningRecord> calculate();
     bool canRun() { return payload != nullptr && algorithm != nullptr; }
     void cleanCurrentLocation();
     void canExport();
-    void writeSummary(std::string houseName,std::filesystem::path outputPath,std::string algorithmName,bool errored);
     void writeOutFile(std::ofstream &writeStream);
+    void writeOutHeader(std::ostream &writeStream);
 
 private:
     std::shared_ptr<CleaningRecord> record = nullptr;
-    std::unique_ptr<VacuumPayload> payload = nullptr;
+    std::shared_ptr<const VacuumPayload> payload = nullptr;
     std::unique_ptr<AbstractAlgorithm> algorithm = nullptr;
     std::filesystem::path fileInputpath;
-    bool timedOut = false;
+    std::atomic<bool> timedOut = false;
+    bool keepHistory = true;
+    std::unique_ptr<StepStreamWriter> stepWriter = nullptr;
 };
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+/**
+ * A single thread that watches the deadlines of every running simulation, instead of a timer and a thread per simulation.
+ * Deadlines are kept in a min-heap, a disarmed deadline is only dropped from the heap once it reaches the top.
+ * Timeout callbacks run on the watchdog thread while holding its lock, so they must be short, and once disarm returns
+ * the callback of that deadline is guaranteed not to be running nor to run later
+ */
+class Watchdog
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+        using DeadlineId = uint64_t;
+        /**
+         * Called once its deadline passes, returns the next deadline to look again at or nothing once it is done
+         */
+        using Check = std::function<std::optional<Clock::time_point>()>;
+        Watchdog();
+        ~Watchdog();
+        Watchdog(const Watchdog &) = delete;
+        Watchdog &operator=(const Watchdog &) = delete;
+        DeadlineId arm(Clock::time_point deadline, std::function<void()> onTimeout);
+        DeadlineId armRechecked(Clock::time_point deadline, Check check);
+        DeadlineId armCpuTime(Clock::duration limit, Clock::duration backstop, std::function<void()> onTimeout);
+        void disarm(DeadlineId id);
+        std::size_t armedCount();
+    private:
+        void watch();
+        using HeapEntry = std::pair<Clock::time_point, DeadlineId>;
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> deadlines;
+        std::unordered_map<DeadlineId, Check> callbacks;
+        DeadlineId nextId = 0;
+        bool stopping = false;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::thread thread;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+/**
+ * A fixed set of long lived workers, each with its own deque of jobs. Jobs are handed out round robin,
+ * a worker takes jobs from the front of its own deque and, once it is empty, steals from the back of the others
+ */
+class WorkStealingPool
+{
+    public:
+        using Job = std::function<void()>;
+        WorkStealingPool(std::size_t numWorkers);
+        ~WorkStealingPool();
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+        void submit(Job job);
+        void wait();
+        std::size_t size() const { return threads.size(); };
+    private:
+        class Worker
+        {
+            public:
+                std::mutex mutex;
+                std::deque<Job> jobs;
+        };
+        bool tryTake(std::size_t self, Job &job);
+        void work(std::size_t self);
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+        std::atomic<std::size_t> nextWorker = 0;
+        std::mutex stateMutex;
+        std::condition_variable jobQueued;
+        std::condition_variable allDone;
+        std::size_t queuedJobs = 0;
+        std::size_t pendingJobs = 0;
+        bool stopping = false;
+};
@@ -18,6 +18,9 @@ class MappingTest : public BFSCleaingAfterMappingAlgorithmTest
 class CleaningTest : public BFSCleaingAfterMappingAlgorithmTest
 {
 };
+class PlanningTest : public BFSCleaingAfterMappingAlgorithmTest
+{
+};
 
 TEST_F(FutileTest, minHouse)
 {
@@ -49,7 +52,7 @@ TEST_F(MappingTest, lineHouseSomeUnmappable)
     StartTest("../../simulator/test/examples/mappingTest/house-linemappable-not-cleanable.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_NE(record->size(), 1000);
-    ASSERT_EQ(record->last()->getDirtLevel(), 9);
+    ASSERT_EQ(record->last().getDirtLevel(), 9);
 }
 
 TEST_F(MappingTest, cleanHouse)
@@ -63,7 +66,7 @@ TEST_F(MappingTest, lineHouse)
     StartTest("../../simulator/test/examples/futileTest/house-line.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_NE(record->size(), 1000);
-    ASSERT_EQ(record->last()->getDirtLevel(), 9);
+    ASSERT_EQ(record->last().getDirtLevel(), 9);
 }
 
 TEST_F(MappingTest, bigEmptyWithReturningToChargeSomeUnmappble)
@@ -71,63 +74,63 @@ TEST_F(MappingTest, bigEmptyWithReturningToChargeSomeUnmappble)
     StartTest("../../simulator/test/examples/mappingTest/house-bigEmpty-someUnmappable.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_NE(record->size(), 100000);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(MappingTest, bigEmptyWithReturningToChargeAllDiscoverable)
 {
     StartTest("../../simulator/test/examples/mappingTest/house-bigEmpty.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_NE(record->size(), 100000);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(MappingTest, bigEmptyWithReturningToChargeSomeUnDiscoverable)
 {
     StartTest("../../simulator/test/examples/mappingTest/house-bigEmpty-allFoundButSomeUndiscoverable.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_NE(record->size(), 100000);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(CleaningTest, house)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house.house");
     ASSERT_EQ(record->size(), 10);
-    ASSERT_EQ((*record)[0]->getDirtLevel(), 26);
-    ASSERT_LT(record->last()->getDirtLevel(), 26);
+    ASSERT_EQ((*record)[0].getDirtLevel(), 26);
+    ASSERT_LT(record->last().getDirtLevel(), 26);
 }
 TEST_F(CleaningTest, houseCorridors)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-coridors.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 100);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(CleaningTest, houseCorridorsWithEmptyRows)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-empty-rows-counted-as-corridors.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 11);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(CleaningTest, houseMaxSteps)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-maxsteps.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_EQ(record->size(), 5);
-    ASSERT_EQ(record->last()->getDirtLevel(), 6);
+    ASSERT_EQ(record->last().getDirtLevel(), 6);
 }
 TEST_F(CleaningTest, houseExatStepsAsMaxTest)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-partial-exact-steps.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LE(record->size(), 32);
-    ASSERT_EQ(record->last()->getDirtLevel(), 17);
+    ASSERT_EQ(record->last().getDirtLevel(), 17);
 }
 TEST_F(CleaningTest, littleBattery)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-return-small-battery2.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 200);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 
 TEST_F(CleaningTest, narrowHouse)
@@ -135,49 +138,49 @@ TEST_F(CleaningTest, narrowHouse)
     StartTest("../../simulator/test/examples/cleaningTest/house-narrow.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 25);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(CleaningTest, narrowHouseExactBattery)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-narrow-exact-battery-andsteps.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 25);
-    ASSERT_LT(record->last()->getDirtLevel(), 4);
+    ASSERT_LT(record->last().getDirtLevel(), 4);
 }
 TEST_F(CleaningTest, narrowHouseExactSteps)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-narrow-exact-battery.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 25);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(CleaningTest, housePartial)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-partial.house");
     ASSERT_NE(record->size(), 0);
     ASSERT_NE(record->size(), 1000);
-    ASSERT_GT((*record)[0]->getDirtLevel(), 17);
-    ASSERT_EQ(record->last()->getDirtLevel(), 17);
+    ASSERT_GT((*record)[0].getDirtLevel(), 17);
+    ASSERT_EQ(record->last().getDirtLevel(), 17);
 }
 TEST_F(CleaningTest, houseSparse)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-sparse.house");
-    ASSERT_GT((*record)[0]->getDirtLevel(), 100);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_GT((*record)[0].getDirtLevel(), 100);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
 }
 TEST_F(CleaningTest, houseSparse2)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-sparse2.house");
-    ASSERT_GT((*record)[0]->getDirtLevel(), 10);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_GT((*record)[0].getDirtLevel(), 10);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 2500);
 }
 TEST_F(CleaningTest, houseBig)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-big.house");
-    ASSERT_GT((*record)[0]->getDirtLevel(), 200);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_GT((*record)[0].getDirtLevel(), 200);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 10000);
     std::cout << record->size() << std::endl;
@@ -185,8 +188,15 @@ TEST_F(CleaningTest, houseBig)
 TEST_F(CleaningTest, houseBig1)
 {
     StartTest("../../simulator/test/examples/cleaningTest/house-big-1.house");
-    ASSERT_GT((*record)[0]->getDirtLevel(), 1000);
-    ASSERT_EQ(record->last()->getDirtLevel(), 0);
+    ASSERT_GT((*record)[0].getDirtLevel(), 1000);
+    ASSERT_EQ(record->last().getDirtLevel(), 0);
     ASSERT_NE(record->size(), 0);
     ASSERT_LT(record->size(), 7000);
-}
\ No newline at end of file
+}
+TEST_F(PlanningTest, matchesStepByStep)
+{
+    for (auto directory : {"cleaningTest", "mappingTest", "futileTest"})
+    {
+        ExpectPlanMatchesStepByStep(std::filesystem::path("../../simulator/test/examples") / directory, "../../badAndGoodLib/libAlgo_323012971_315441972_Orignal.so");
+    }
+}
@@ -1,9 +1,12 @@
 #include "BatchVacuumSimulator.hpp"
 #include "SimulationArguments.hpp"
+#include "AlgorithmRegistrar.h"
 #include <gtest/gtest.h>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 
 namespace fs = std::filesystem;
 
@@ -13,6 +16,10 @@ struct TestParams {
     bool summaryOnly;
     bool shouldCsv;
     std::vector<std::string> validAlgorithms;
+    bool streamOutput = false;
+    bool isolate = false;
+    bool cpuTime = false;
+    std::size_t memoryBudget = 0;
 };
 class BatchVacuumSimulatorTest : public ::testing::Test {
 protected:
@@ -91,6 +98,19 @@ protected:
         if (params.summaryOnly) {
             argv.push_back("-summary_only");
         }
+        if (params.streamOutput) {
+            argv.push_back("-stream_output");
+        }
+        if (params.isolate) {
+            argv.push_back("-isolate");
+        }
+        if (params.cpuTime) {
+            argv.push_back("-cpu_time");
+        }
+        std::string memory_arg = std::string("-memory_budget=") + std::to_string(params.memoryBudget);
+        if (params.memoryBudget > 0) {
+            argv.push_back(memory_arg.c_str());
+        }
         int argc = argv.size();
 
         EXPECT_NO_THROW({
@@ -108,6 +128,10 @@ protected:
         }
         assertNotBothErrorAndOutput();
     }
+    std::size_t cachedHouseCount(BatchVacuumSimulator &simulator)
+    {
+        return simulator.houseCache->size();
+    }
     double timedOutRatio(const TestParams& params)
     {
         int maxTimeouts = params.validAlgorithms.size() * houseFiles.size();
@@ -200,12 +224,53 @@ protected:
             }
         }
     }
+    std::map<std::string, std::string> readOutputFiles()
+    {
+        std::map<std::string, std::string> outputs;
+        for (const auto& entry : fs::directory_iterator(fs::current_path())) {
+            std::string filename = entry.path().filename().string();
+            if (filename_not_contains(filename, "CMake") && entry.path().extension() == ".txt") {
+                std::ifstream file(entry.path());
+                std::stringstream content;
+                content << file.rdbuf();
+                outputs[filename] = content.str();
+            }
+        }
+        return outputs;
+    }
+    /**
+     * Columns of summary.csv are in the order the houses finished, so scores are compared by algorithm and house
+     */
+    std::map<std::pair<std::string, std::string>, std::string> readSummaryScores()
+    {
+        std::map<std::pair<std::string, std::string>, std::string> scores;
+        std::ifstream file("summary.csv");
+        std::string line;
+        std::vector<std::string> houseNames;
+        while (std::getline(file, line)) {
+            std::stringstream lineStream(line);
+            std::string cell;
+            std::vector<std::string> cells;
+            while (std::getline(lineStream, cell, ',')) {
+                cells.push_back(cell);
+            }
+            if (houseNames.empty()) {
+                houseNames = cells;
+                continue;
+            }
+            for (std::size_t i = 1; i < cells.size() && i < houseNames.size(); i++) {
+                scores[{cells[0], houseNames[i]}] = cells[i];
+            }
+        }
+        return scores;
+    }
     std::vector<std::filesystem::path> houseFiles;
     std::vector<std::filesystem::path> algoFiles;
     public:
         inline static const fs::path LIBPATH = "../../lib";
         inline static const fs::path ALLLIBS = "../../allLib";
         inline static const fs::path CLEANINGTEST = "../../simulator/test/examples/cleaningTest";
+        inline static const fs::path FUTILETEST = "../../simulator/test/examples/futileTest";
         inline static const fs::path MIXFAILERANDSUCCESHOUSE = "../../simulator/test/examples/mixFailerAndSuccesHouse";
         inline static const fs::path FAILTESTS = "../../simulator/test/examples/failtests";
         inline static const fs::path BADLIB = "../../badLib";
@@ -284,4 +349,101 @@ TEST_F(BatchVacuumSimulatorTest, AllAlgorithmsMixedResults)
     ASSERT_LT(erroredOutFileRatio(params), 1);
     ASSERT_GT(erroredOutFileRatio(params), 0);
     
-}
\ No newline at end of file
+}
+TEST_F(BatchVacuumSimulatorTest, StreamedOutputMatchesBufferedOutput)
+{
+    auto params = TestParams{ FUTILETEST, LIBPATH, false, true, {"libAlgo_323012971_315441972_Simultaneous", "libAlgo_323012971_315441972_Orignal"}};
+    loadRun(params);
+    auto bufferedOutputs = readOutputFiles();
+    ASSERT_FALSE(bufferedOutputs.empty());
+    SetUp();
+    params.streamOutput = true;
+    loadRun(params);
+    assertCorrectErrorFilesCreated(params);
+    ASSERT_EQ(readOutputFiles(), bufferedOutputs);
+}
+TEST_F(BatchVacuumSimulatorTest, IsolatedOutputMatchesThreadedOutput)
+{
+    auto params = TestParams{ FUTILETEST, LIBPATH, false, true, {"libAlgo_323012971_315441972_Simultaneous", "libAlgo_323012971_315441972_Orignal"}};
+    loadRun(params);
+    auto threadedOutputs = readOutputFiles();
+    auto threadedScores = readSummaryScores();
+    ASSERT_FALSE(threadedOutputs.empty());
+    SetUp();
+    params.isolate = true;
+    loadRun(params);
+    assertCorrectErrorFilesCreated(params);
+    ASSERT_EQ(readOutputFiles(), threadedOutputs);
+    ASSERT_EQ(readSummaryScores(), threadedScores);
+}
+TEST_F(BatchVacuumSimulatorTest, IsolatedTimeoutScoresMatchThreadedTimeoutScores)
+{
+    // Which runs time out is random, but the houses are identical so every run that timed out has to score the same
+    auto params = TestParams{TIMEOUTTEST, SOMETIMESTIMEOUTLIB, false, true, {"libtimingOutSometimes"}};
+    std::map<bool, std::set<std::string>> scoresByTimeout;
+    auto collectScores = [&]() {
+        for (const auto& [key, score] : readSummaryScores()) {
+            scoresByTimeout[wasTimedOut(generateOutputFileName(key.second, key.first))].insert(score);
+        }
+    };
+    loadRun(params);
+    ASSERT_GT(timedOutRatio(params), 0);
+    collectScores();
+    SetUp();
+    params.isolate = true;
+    loadRun(params);
+    ASSERT_GT(timedOutRatio(params), 0);
+    collectScores();
+    for (const auto& [timedOut, scores] : scoresByTimeout) {
+        ASSERT_EQ(scores.size(), 1) << (timedOut ? "timed out" : "finished") << " runs scored differently";
+    }
+}
+TEST_F(BatchVacuumSimulatorTest, IsolatedRunWithMixedResults)
+{
+    auto params = TestParams{ MIXFAILERANDSUCCESHOUSE,ALLLIBS, false, true,
+    {"libtimingOutSometimesFaultySometimes","libtimingOut","libtimingOutSometimes","libfaultyAlgorithm","libAlgo_323012971_315441972_Simultaneous", "libAlgo_323012971_315441972_Orignal"}};
+    params.isolate = true;
+    loadRun(params);
+    assertCorrectAlgorithmErrorFilesCreated(params);
+    ASSERT_LT(timedOutRatio(params), 1);
+    ASSERT_GT(timedOutRatio(params), 0);
+    ASSERT_LT(erroredOutFileRatio(params), 1);
+    ASSERT_GT(erroredOutFileRatio(params), 0);
+}
+TEST_F(BatchVacuumSimulatorTest, CpuTimeLimitStillTimesOut)
+{
+    // The algorithm sleeps through its steps, so it uses no CPU time and only the wall time backstop can stop it
+    auto params = TestParams{ TIMEOUTTEST, RUNTIMEBADLIB, false, true, {"libtimingOut"}};
+    params.cpuTime = true;
+    loadRun(params);
+    assertCorrectAlgorithmErrorFilesCreated(params);
+    ASSERT_EQ(timedOutRatio(params), 1.0);
+}
+TEST_F(BatchVacuumSimulatorTest, MemoryBudgetKeepsResults)
+{
+    auto params = TestParams{ FUTILETEST, LIBPATH, false, true, {"libAlgo_323012971_315441972_Simultaneous", "libAlgo_323012971_315441972_Orignal"}};
+    loadRun(params);
+    auto unlimitedOutputs = readOutputFiles();
+    auto unlimitedScores = readSummaryScores();
+    SetUp();
+    // Below what a single run needs, every run still has to be admitted and produce the same results
+    params.memoryBudget = 1;
+    loadRun(params);
+    assertCorrectErrorFilesCreated(params);
+    ASSERT_EQ(readOutputFiles(), unlimitedOutputs);
+    ASSERT_EQ(readSummaryScores(), unlimitedScores);
+}
+TEST_F(BatchVacuumSimulatorTest, ThrowingFactoryReleasesHouses)
+{
+    AlgorithmRegistrar::getAlgorithmRegistrar().registerAlgorithm("throwingFactory", []() -> std::unique_ptr<AbstractAlgorithm> {
+        throw std::runtime_error("Factory failed");
+    });
+    std::string house_arg = std::string("-house_path=") + CLEANINGTEST.string();
+    std::string algo_arg = std::string("-algo_path=") + LIBPATH.string();
+    std::vector<const char*> argv = {"Simulator", house_arg.c_str(), algo_arg.c_str()};
+    SimulationArguments args(argv.size(), const_cast<char**>(argv.data()));
+    BatchVacuumSimulator simulator;
+    simulator.run(args);
+    // Every house had a run that never acquired it, the house has to leave the cache all the same
+    ASSERT_EQ(cachedHouseCount(simulator), 0);
+}
@@ -17,12 +17,12 @@ TEST(CleaningRecordTest, Add) {
     record.add(step2);
     ASSERT_EQ(record.size(), 1);
 
-    ASSERT_EQ(*record[0], step2);
-    ASSERT_EQ(*record.last(), step2);
-    ASSERT_EQ(record[0]->getLocationType(), LocationType::CHARGING_STATION);
-    ASSERT_EQ(record[0]->getStep(), Step::South);
-    ASSERT_EQ(record[0]->getBatteryLevel(), 10);
-    ASSERT_EQ(record[0]->getDirtLevel(), 20);
+    ASSERT_EQ(record[0], step2);
+    ASSERT_EQ(record.last(), step2);
+    ASSERT_EQ(record[0].getLocationType(), LocationType::CHARGING_STATION);
+    ASSERT_EQ(record[0].getStep(), Step::South);
+    ASSERT_EQ(record[0].getBatteryLevel(), 10);
+    ASSERT_EQ(record[0].getDirtLevel(), 20);
 }
 
 TEST(CleaningRecordTest, InitialValue) {
@@ -31,13 +31,80 @@ TEST(CleaningRecordTest, InitialValue) {
     ASSERT_EQ(record.size(), 0);
     ASSERT_EQ(*record.getInitialStep(), step);
     ASSERT_EQ(record.size(), 0);
-    ASSERT_EQ(record[0], record.getInitialStep());
-    ASSERT_EQ(record.last(), record.getInitialStep());
+    ASSERT_EQ(record[0], *record.getInitialStep());
+    ASSERT_EQ(record.last(), *record.getInitialStep());
     CleaningRecordStep otherStep = CleaningRecordStep(LocationType::CHARGING_STATION, Step::South, 10, 20);
     record.add(otherStep);
     ASSERT_EQ(record.size(), 1);
 
-    ASSERT_EQ(record.getInitialStep(), nullptr);
-    ASSERT_EQ(*record[0], otherStep);
-    ASSERT_EQ(*record.last(), otherStep);
-}
\ No newline at end of file
+    ASSERT_FALSE(record.getInitialStep().has_value());
+    ASSERT_EQ(record[0], otherStep);
+    ASSERT_EQ(record.last(), otherStep);
+}
+TEST(CleaningRecordTest, OutOfRange) {
+    CleaningRecordStep step = CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 1, 2);
+    CleaningRecord record(step, 10);
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::West, 0, 2));
+    ASSERT_THROW(record[1], std::out_of_range);
+}
+TEST(CleaningRecordTest, PreservesEveryStep) {
+    CleaningRecordStep step = CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 5, 3);
+    CleaningRecord record(step, 10);
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::North, 4, 3));
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::Stay, 3, 2));
+    record.add(CleaningRecordStep(LocationType::CHARGING_STATION, Step::South, 2, 2));
+    record.add(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Finish, 2, 2));
+    ASSERT_EQ(record.size(), 3);
+    ASSERT_EQ(record.getInitialDirt(), 3);
+    ASSERT_EQ(record[1], CleaningRecordStep(LocationType::HOUSE_TILE, Step::Stay, 3, 2));
+    ASSERT_EQ(record[2], CleaningRecordStep(LocationType::CHARGING_STATION, Step::South, 2, 2));
+    ASSERT_EQ(record.getStatus(), Status::FINISHED);
+    std::stringstream ss;
+    ss << record;
+    ASSERT_EQ(ss.str(), "NsSF");
+}
+TEST(CleaningRecordTest, InitialDirtWithoutSteps) {
+    CleaningRecordStep step = CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 5, 3);
+    CleaningRecord record(step, 10);
+    ASSERT_EQ(record.size(), 0);
+    ASSERT_EQ(record.getInitialDirt(), 3);
+}
+TEST(CleaningRecordTest, WithoutHistory) {
+    CleaningRecordStep step = CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 5, 3);
+    CleaningRecord record(step, 10, false);
+    ASSERT_FALSE(record.isKeepingHistory());
+    ASSERT_EQ(record.size(), 0);
+    ASSERT_EQ(record.last(), step);
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::North, 4, 3));
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::Stay, 3, 2));
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::Stay, 0, 1));
+    ASSERT_EQ(record.size(), 3);
+    ASSERT_EQ(record.getInitialDirt(), 3);
+    ASSERT_EQ(record.last(), CleaningRecordStep(LocationType::HOUSE_TILE, Step::Stay, 0, 1));
+    ASSERT_EQ(record[2], record.last());
+    ASSERT_THROW(record[0], std::out_of_range);
+    ASSERT_EQ(record.getStatus(), Status::DEAD);
+    std::stringstream ss;
+    ss << record;
+    ASSERT_EQ(ss.str(), "");
+}
+TEST(CleaningRecordTest, ChargingRun) {
+    CleaningRecordStep step = CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 3, 4);
+    CleaningRecord record(step, 100);
+    MeteredVacuumBattery battery(0, 3);
+    record.add(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 0, 4));
+    auto batteryBefore = battery;
+    battery.charge(20);
+    record.addCharging(CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, battery.getBatteryState(), 4), 20, batteryBefore);
+    record.add(CleaningRecordStep(LocationType::HOUSE_TILE, Step::North, 2, 4));
+    ASSERT_EQ(record.size(), 22);
+    ASSERT_EQ(record[1], CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 0, 4));
+    ASSERT_EQ(record[7], CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 1, 4));
+    ASSERT_EQ(record[20], CleaningRecordStep(LocationType::CHARGING_STATION, Step::Stay, 3, 4));
+    ASSERT_EQ(record[21], CleaningRecordStep(LocationType::HOUSE_TILE, Step::North, 2, 4));
+    ASSERT_EQ(record.last(), record[21]);
+    ASSERT_THROW(record[22], std::out_of_range);
+    std::stringstream ss;
+    ss << record;
+    ASSERT_EQ(ss.str(), std::string(21, 's') + "N");
+}
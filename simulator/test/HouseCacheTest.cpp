@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "HouseCache.hpp"
+#include <thread>
+
+TEST(HouseCacheTest, SharesParsedHouse)
+{
+    std::filesystem::path filepath = "../../simulator/test/examples/cleaningTest/house-coridors.house";
+    HouseCache cache(3);
+    auto first = cache.acquire(filepath);
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(cache.size(), 1);
+    auto second = cache.acquire(filepath);
+    ASSERT_EQ(first, second);
+    auto third = cache.acquire(filepath);
+    ASSERT_EQ(first, third);
+    ASSERT_EQ(cache.size(), 0);
+    ASSERT_TRUE(first->getHouse().isWall(Direction::West));
+}
+TEST(HouseCacheTest, ParsesAgainAfterAllUses)
+{
+    std::filesystem::path filepath = "../../simulator/test/examples/cleaningTest/house-coridors.house";
+    HouseCache cache(1);
+    auto first = cache.acquire(filepath);
+    ASSERT_EQ(cache.size(), 0);
+    auto second = cache.acquire(filepath);
+    ASSERT_NE(first, second);
+    ASSERT_EQ(first->getMaxSteps(), second->getMaxSteps());
+}
+TEST(HouseCacheTest, ReleasedUsesCount)
+{
+    std::filesystem::path filepath = "../../simulator/test/examples/cleaningTest/house-coridors.house";
+    HouseCache cache(3);
+    cache.release(filepath);
+    ASSERT_EQ(cache.size(), 1);
+    auto payload = cache.acquire(filepath);
+    ASSERT_NE(payload, nullptr);
+    cache.release(filepath);
+    ASSERT_EQ(cache.size(), 0);
+}
+TEST(HouseCacheTest, InvalidHouseThrowsForEveryUse)
+{
+    std::filesystem::path filepath = "../../simulator/test/examples/failtests/house-failed-noCharging.house";
+    HouseCache cache(2);
+    ASSERT_THROW(cache.acquire(filepath), std::invalid_argument);
+    ASSERT_THROW(cache.acquire(filepath), std::invalid_argument);
+    ASSERT_EQ(cache.size(), 0);
+}
+TEST(HouseCacheTest, ConcurrentAcquire)
+{
+    std::filesystem::path filepath = "../../simulator/test/examples/cleaningTest/house-big.house";
+    constexpr uint32_t threadCount = 8;
+    HouseCache cache(threadCount);
+    std::vector<std::shared_ptr<const VacuumPayload>> payloads(threadCount);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&, i]() { payloads[i] = cache.acquire(filepath); });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto &payload : payloads)
+    {
+        ASSERT_EQ(payload, payloads[0]);
+    }
+    ASSERT_EQ(cache.size(), 0);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "MemoryBudget.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(MemoryBudgetTest, EstimateGrowsWithHouse)
+{
+    auto small = MemoryBudget::estimate(HouseHeader{100, 10, 10, 10}, true);
+    auto large = MemoryBudget::estimate(HouseHeader{100, 10, 1000, 1000}, true);
+    ASSERT_GT(large, small * 100);
+    ASSERT_LT(MemoryBudget::estimate(HouseHeader{100000, 10, 10, 10}, false), MemoryBudget::estimate(HouseHeader{100000, 10, 10, 10}, true));
+    ASSERT_GT(MemoryBudget::readResidentBytes(), 0);
+}
+TEST(MemoryBudgetTest, WaitsForRoom)
+{
+    // Far above what this test allocates, so the measured size does not get in the way
+    constexpr std::size_t gigabyte = 1024 * 1024 * 1024;
+    MemoryBudget budget(4 * gigabyte);
+    std::atomic<bool> admitted = false;
+    {
+        auto first = budget.reserve(3 * gigabyte);
+        ASSERT_EQ(budget.getReservedBytes(), 3 * gigabyte);
+        std::thread second([&]() {
+            // Too large to fit next to the first run even at the smallest scale
+            auto reservation = budget.reserve(6 * gigabyte);
+            admitted = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        ASSERT_FALSE(admitted);
+        first = MemoryBudget::Reservation();
+        second.join();
+    }
+    ASSERT_TRUE(admitted);
+    ASSERT_EQ(budget.getReservedBytes(), 0);
+}
+TEST(MemoryBudgetTest, AdmitsOversizedRunAlone)
+{
+    MemoryBudget budget(1024);
+    auto reservation = budget.reserve(1024 * 1024);
+    ASSERT_EQ(budget.getReservedBytes(), 1024 * 1024);
+}
+TEST(MemoryBudgetTest, ScaleFollowsMeasuredSize)
+{
+    MemoryBudget budget(std::size_t(64) * 1024 * 1024 * 1024);
+    auto reservation = budget.reserve(1);
+    // Far more resident memory than the single byte reserved, the estimates are scaled up
+    std::vector<char> used(64 * 1024 * 1024, 1);
+    auto other = budget.reserve(1);
+    ASSERT_GT(budget.getScale(), 1);
+    ASSERT_LE(budget.getScale(), MemoryBudget::MAX_SCALE);
+}
+TEST(MemoryBudgetTest, MemoryHeldBetweenRunsIsNotCharged)
+{
+    constexpr std::size_t megabyte = 1024 * 1024;
+    MemoryBudget budget(64 * megabyte);
+    {
+        auto reservation = budget.reserve(megabyte);
+    }
+    // Grown while nothing runs, like a parsed house waiting in the cache, and larger than the whole budget
+    std::vector<char> held(256 * megabyte, 1);
+    auto first = budget.reserve(megabyte);
+    std::atomic<bool> admitted = false;
+    std::thread second([&]() {
+        auto reservation = budget.reserve(megabyte);
+        admitted = true;
+    });
+    for (int i = 0; i < 100 && !admitted; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    bool wasAdmitted = admitted;
+    first = MemoryBudget::Reservation();
+    second.join();
+    ASSERT_TRUE(wasAdmitted);
+    ASSERT_LE(budget.getScale(), 1);
+}
@@ -99,4 +99,36 @@ TEST(VaccumTest, Mixed) {
   ASSERT_EQ(vacuumBattery.getBatteryState(), 20);
   vacuumBattery.try_activate();
   ASSERT_EQ(vacuumBattery.getBatteryState(), 19);
-}
\ No newline at end of file
+}
+TEST(VaccumTest, ChargeQueries) {
+  MeteredVacuumBattery vacuumBattery(0,3);
+  ASSERT_EQ(vacuumBattery.getMaxBatteryState(), 3);
+  ASSERT_EQ(vacuumBattery.getBatteryStateAfterCharging(6), 0);
+  ASSERT_EQ(vacuumBattery.getBatteryStateAfterCharging(7), 1);
+  ASSERT_EQ(vacuumBattery.getBatteryStateAfterCharging(1000), 3);
+  ASSERT_EQ(vacuumBattery.getChargeStepsToReach(0), 0);
+  ASSERT_EQ(vacuumBattery.getChargeStepsToReach(1), 7);
+  ASSERT_EQ(vacuumBattery.getChargeStepsToReach(3), 20);
+  ASSERT_FALSE(vacuumBattery.getChargeStepsToReach(4).has_value());
+  vacuumBattery.charge(*vacuumBattery.getChargeStepsToReach(2));
+  ASSERT_EQ(vacuumBattery.getBatteryState(), 2);
+  ASSERT_EQ(vacuumBattery.getBatteryStateAfterCharging(0), 2);
+}
+TEST(VaccumTest, ChargeQueriesMatchStepByStepCharging) {
+  for (uint32_t maxBattery : {1u, 3u, 7u, 20u, 33u, 100u}) {
+    MeteredVacuumBattery stepped(0, maxBattery);
+    MeteredVacuumBattery queried(0, maxBattery);
+    for (uint32_t steps = 1; steps <= 25; steps++) {
+      stepped.charge();
+      ASSERT_EQ(stepped.getBatteryState(), queried.getBatteryStateAfterCharging(steps));
+    }
+  }
+}
+TEST(VaccumTest, EmptyBatteryNeverCharges) {
+  MeteredVacuumBattery vacuumBattery(0,0);
+  vacuumBattery.charge(100);
+  ASSERT_EQ(vacuumBattery.getBatteryState(), 0);
+  ASSERT_EQ(vacuumBattery.getChargeStepsToReach(0), 0);
+  ASSERT_FALSE(vacuumBattery.getChargeStepsToReach(1).has_value());
+  ASSERT_FALSE(vacuumBattery.try_activate());
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include "OutputWriter.hpp"
+#include <fstream>
+#include <sstream>
+
+std::string readOutput(const std::filesystem::path &path)
+{
+    std::ifstream inFile(path);
+    std::stringstream content;
+    content << inFile.rdbuf();
+    return content.str();
+}
+TEST(OutputWriterTest, WritesInOrder)
+{
+    std::vector<std::filesystem::path> paths;
+    {
+        OutputWriter output;
+        for (int i = 0; i < 20; i++)
+        {
+            paths.emplace_back("OutputWriterTest-" + std::to_string(i) + ".txt");
+            output.write(paths.back(), [i](std::ostream &writeStream) { writeStream << "file " << i << std::endl; });
+        }
+        // Same path again, the later write has to win
+        output.write(paths.front(), [](std::ostream &writeStream) { writeStream << "rewritten" << std::endl; });
+    }
+    ASSERT_EQ(readOutput(paths.front()), "rewritten\n");
+    for (int i = 1; i < 20; i++)
+    {
+        ASSERT_EQ(readOutput(paths[i]), "file " + std::to_string(i) + "\n");
+    }
+    for (const auto &path : paths)
+    {
+        std::filesystem::remove(path);
+    }
+}
+TEST(OutputWriterTest, WritesLargeFile)
+{
+    std::filesystem::path path = "OutputWriterTest-large.txt";
+    std::string line(100, 'x');
+    OutputWriter output;
+    output.write(path, [&line](std::ostream &writeStream) {
+        for (std::size_t i = 0; i < 3 * OutputWriter::BUFFER_SIZE / line.size(); i++)
+        {
+            writeStream << line << '\n';
+        }
+    });
+    output.flush();
+    ASSERT_EQ(std::filesystem::file_size(path), 3 * OutputWriter::BUFFER_SIZE / line.size() * (line.size() + 1));
+    std::filesystem::remove(path);
+}
+TEST(OutputWriterTest, ReportsErrors)
+{
+    OutputWriter output;
+    std::string error;
+    output.write("missing-directory/OutputWriterTest.txt", [](std::ostream &writeStream) { writeStream << "lost"; },
+                 [&error](const std::string &what) { error = what; });
+    output.submit([]() { throw std::runtime_error("failed job"); }, [&error](const std::string &what) { error += what; });
+    output.flush();
+    ASSERT_EQ(error, "Unable to open file.failed job");
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "ProcessPool.hpp"
+#include <chrono>
+#include <csignal>
+#include <map>
+#include <thread>
+#include <unistd.h>
+
+TEST(ProcessPoolTest, RunsEveryTaskInWorkers)
+{
+    auto parent = ::getpid();
+    ProcessPool pool(3, [parent](std::size_t task, const ProcessPool::TaskControl &) {
+        return std::to_string(task * task) + (::getpid() == parent ? " parent" : " worker");
+    });
+    ASSERT_EQ(pool.size(), 3);
+    std::map<std::size_t, std::string> results;
+    pool.run(50, [&results](std::size_t task, ProcessPool::Outcome outcome, const std::string &result) {
+        ASSERT_EQ(outcome, ProcessPool::Outcome::Finished);
+        results[task] = result;
+    });
+    ASSERT_EQ(results.size(), 50);
+    for (std::size_t task = 0; task < 50; task++)
+    {
+        ASSERT_EQ(results[task], std::to_string(task * task) + " worker");
+    }
+}
+TEST(ProcessPoolTest, KillsTaskPastItsLimit)
+{
+    ProcessPool pool(2, [](std::size_t task, const ProcessPool::TaskControl &control) {
+        control.setTimeLimit(std::chrono::milliseconds(100), "killed " + std::to_string(task));
+        if (task % 2 == 0)
+        {
+            // Never gives the core back on its own
+            volatile std::size_t spins = 0;
+            while (true)
+            {
+                spins = spins + 1;
+            }
+        }
+        control.clearTimeLimit();
+        return "done " + std::to_string(task);
+    });
+    std::map<std::size_t, std::pair<ProcessPool::Outcome, std::string>> results;
+    auto start = std::chrono::steady_clock::now();
+    pool.run(6, [&results](std::size_t task, ProcessPool::Outcome outcome, const std::string &result) { results[task] = {outcome, result}; });
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    for (std::size_t task = 0; task < 6; task++)
+    {
+        if (task % 2 == 0)
+        {
+            ASSERT_EQ(results[task], std::make_pair(ProcessPool::Outcome::TimedOut, "killed " + std::to_string(task)));
+        }
+        else
+        {
+            ASSERT_EQ(results[task], std::make_pair(ProcessPool::Outcome::Finished, "done " + std::to_string(task)));
+        }
+    }
+}
+TEST(ProcessPoolTest, ReplacesCrashedWorker)
+{
+    ProcessPool pool(1, [](std::size_t task, const ProcessPool::TaskControl &control) {
+        control.setTimeLimit(std::chrono::seconds(10), "crashed " + std::to_string(task));
+        if (task == 1)
+        {
+            std::raise(SIGSEGV);
+        }
+        return "done " + std::to_string(task);
+    });
+    std::map<std::size_t, std::pair<ProcessPool::Outcome, std::string>> results;
+    pool.run(3, [&results](std::size_t task, ProcessPool::Outcome outcome, const std::string &result) { results[task] = {outcome, result}; });
+    ASSERT_EQ(results[0], std::make_pair(ProcessPool::Outcome::Finished, std::string("done 0")));
+    ASSERT_EQ(results[1], std::make_pair(ProcessPool::Outcome::Crashed, std::string("crashed 1")));
+    ASSERT_EQ(results[2], std::make_pair(ProcessPool::Outcome::Finished, std::string("done 2")));
+}
+TEST(ProcessPoolTest, KeepsGroupOnItsWorker)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ProcessPool pool(2, [fds](std::size_t task, const ProcessPool::TaskControl &) {
+        // The second group waits for the first to be done, so the other worker is free to take any of its tasks
+        char done = 0;
+        if (task == 2 && ::write(fds[1], &done, 1) != 1)
+        {
+            return std::string();
+        }
+        if (task == 3 && ::read(fds[0], &done, 1) != 1)
+        {
+            return std::string();
+        }
+        return std::to_string(::getpid());
+    });
+    std::map<std::size_t, std::string> results;
+    pool.run(6, [&results](std::size_t task, ProcessPool::Outcome, const std::string &result) { results[task] = result; }, [](std::size_t task) { return task / 3; });
+    ::close(fds[0]);
+    ::close(fds[1]);
+    ASSERT_FALSE(results[0].empty());
+    ASSERT_EQ(results[1], results[0]);
+    ASSERT_EQ(results[2], results[0]);
+    ASSERT_NE(results[3], results[0]);
+}
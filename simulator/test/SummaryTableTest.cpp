@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include "SummaryTable.hpp"
+#include <fstream>
+#include <sstream>
+
+std::string readSummary(const std::filesystem::path &path)
+{
+    std::ifstream inFile(path);
+    std::stringstream content;
+    content << inFile.rdbuf();
+    return content.str();
+}
+TEST(SummaryTableTest, WritesMatrix)
+{
+    std::filesystem::path path = "SummaryTableTest-matrix.csv";
+    std::filesystem::remove(path);
+    SummaryTable summary(path);
+    ASSERT_FALSE(summary.isChanged());
+    summary.set("algo1", "house1", 10);
+    summary.set("algo2", "house2", 20);
+    summary.set("algo1", "house2", std::nullopt);
+    ASSERT_TRUE(summary.isChanged());
+    summary.write();
+    ASSERT_FALSE(summary.isChanged());
+    ASSERT_EQ(readSummary(path), ",house1,house2,\nalgo1,10,,\nalgo2,,20,\n");
+    std::filesystem::remove(path);
+}
+TEST(SummaryTableTest, KeepsExistingScores)
+{
+    std::filesystem::path path = "SummaryTableTest-existing.csv";
+    {
+        std::ofstream outFile(path);
+        outFile << ",house1,\nalgo1,10,\n";
+    }
+    SummaryTable summary(path);
+    summary.set("algo1", "house2", 30);
+    summary.set("algo1", "house1", 15);
+    summary.write();
+    ASSERT_EQ(readSummary(path), ",house1,house2,\nalgo1,15,30,\n");
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "TaskScheduler.hpp"
+
+using namespace std::chrono_literals;
+
+HouseHeader makeHeader(uint32_t maxSteps, uint32_t rows = 100, uint32_t cols = 100)
+{
+    return HouseHeader{maxSteps, 100, rows, cols};
+}
+TEST(TaskSchedulerTest, LongestFirstAfterFastLane)
+{
+    TaskScheduler scheduler(1, 2);
+    scheduler.add("small.house", makeHeader(1000));
+    scheduler.add("tiny.house", makeHeader(10, 2, 2));
+    scheduler.add("large.house", makeHeader(100000));
+    scheduler.add("broken.house", std::nullopt);
+    scheduler.add("medium.house", makeHeader(10000));
+    scheduler.start();
+    std::vector<std::string> fastLane = {scheduler.next()->houseFile.string(), scheduler.next()->houseFile.string()};
+    std::sort(fastLane.begin(), fastLane.end());
+    ASSERT_EQ(fastLane, std::vector<std::string>({"broken.house", "tiny.house"}));
+    ASSERT_EQ(scheduler.next()->houseFile, "large.house");
+    ASSERT_EQ(scheduler.next()->houseFile, "medium.house");
+    ASSERT_EQ(scheduler.next()->houseFile, "small.house");
+    ASSERT_FALSE(scheduler.next().has_value());
+}
+TEST(TaskSchedulerTest, RunsOfAHouseStayTogether)
+{
+    TaskScheduler scheduler(3, 2);
+    scheduler.add("first.house", makeHeader(1000));
+    scheduler.add("second.house", makeHeader(2000));
+    scheduler.start();
+    for (auto house : {"second.house", "first.house"})
+    {
+        std::vector<std::size_t> ran;
+        for (int i = 0; i < 3; i++)
+        {
+            auto task = scheduler.next();
+            ASSERT_EQ(task->houseFile, house);
+            ran.push_back(task->algorithm);
+        }
+        std::sort(ran.begin(), ran.end());
+        ASSERT_EQ(ran, std::vector<std::size_t>({0, 1, 2}));
+    }
+    ASSERT_FALSE(scheduler.next().has_value());
+}
+TEST(TaskSchedulerTest, PredictsMakespan)
+{
+    TaskScheduler scheduler(1, 2);
+    TaskScheduler::Task task{"house", 0, makeHeader(10000)};
+    auto cost = scheduler.estimate(task);
+    ASSERT_EQ(cost, TaskScheduler::PRIOR_TIME_PER_STEP * 10000 + TaskScheduler::TIME_PER_TILE * 100 * 100);
+    for (int i = 0; i < 3; i++)
+    {
+        scheduler.add("house", task.header);
+    }
+    // Three equal runs on two workers, one worker has to run two of them
+    ASSERT_EQ(scheduler.start(), cost * 2);
+}
+TEST(TaskSchedulerTest, StepsBoundedByHouseSize)
+{
+    TaskScheduler scheduler(1, 1);
+    TaskScheduler::Task task{"house", 0, makeHeader(100000, 10, 10)};
+    auto steps = static_cast<int64_t>(TaskScheduler::PRIOR_STEPS_PER_TILE * 10 * 10);
+    ASSERT_EQ(scheduler.estimate(task), TaskScheduler::PRIOR_TIME_PER_STEP * steps + TaskScheduler::TIME_PER_TILE * 10 * 10);
+}
+TEST(TaskSchedulerTest, LearnsStepsPerTile)
+{
+    TaskScheduler scheduler(1, 1);
+    TaskScheduler::Task task{"house", 0, makeHeader(100000)};
+    auto before = scheduler.estimate(task);
+    // The house was cleaned in far fewer steps than the prior expects for its size
+    scheduler.finished(task, 10ms, 1000);
+    ASSERT_LT(scheduler.estimate(task), before / 2);
+}
+TEST(TaskSchedulerTest, LearnsSlowAlgorithm)
+{
+    TaskScheduler scheduler(2, 1);
+    scheduler.add("first.house", makeHeader(20000));
+    scheduler.add("second.house", makeHeader(10000));
+    scheduler.start();
+    auto first = scheduler.next();
+    ASSERT_EQ(first->houseFile, "first.house");
+    ASSERT_EQ(scheduler.next()->houseFile, "first.house");
+    // The algorithm of the first run turned out much slower than the prior, its run is now the longest on the next house
+    scheduler.finished(*first, 10s, 20000);
+    auto third = scheduler.next();
+    ASSERT_EQ(third->algorithm, first->algorithm);
+    ASSERT_EQ(third->houseFile, "second.house");
+    ASSERT_GT(scheduler.estimate(*third), TaskScheduler::PRIOR_TIME_PER_STEP * 10000 * 10);
+}
+TEST(TaskSchedulerTest, RanksQueuedHousesByWhatWasLearned)
+{
+    TaskScheduler scheduler(1, 1);
+    scheduler.add("probe.house", makeHeader(1000000));
+    // Bounded by its size at first, by MaxSteps once a run turned out to take many steps per tile
+    scheduler.add("roomy.house", makeHeader(100000, 50, 50));
+    scheduler.add("bounded.house", makeHeader(12000));
+    scheduler.start();
+    auto probe = scheduler.next();
+    ASSERT_EQ(probe->houseFile, "probe.house");
+    scheduler.finished(*probe, 4s, 400000);
+    ASSERT_EQ(scheduler.next()->houseFile, "roomy.house");
+    ASSERT_EQ(scheduler.next()->houseFile, "bounded.house");
+    ASSERT_FALSE(scheduler.next().has_value());
+}
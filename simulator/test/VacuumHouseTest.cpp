@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "HouseLocation.hpp"
 #include "VacuumHouse.hpp"
+#include "SensorSnapshot.h"
 
 TEST(HouseTest, Construction) {
     std::vector<std::string> houseLocations = { 
@@ -115,4 +116,99 @@ TEST(HouseTest, outOfBoundsDirtCount)
     };
     VacuumHouse house(houseLocations,rows,cols);
     ASSERT_EQ(house.getTotalDirt(),11);
-}
\ No newline at end of file
+}
+TEST(HouseTest, cleaningUpdatesDirtAggregates)
+{
+    uint32_t rows = 3;
+    uint32_t cols = 3;
+    std::vector<std::string> houseLocations = { 
+        { ' ',  '1',  '2'},
+        { '3', 'D', '5'},
+        { '6',  '1',  '8'}
+    };
+    VacuumHouse house(houseLocations,rows,cols);
+    ASSERT_EQ(house.getTotalDirt(),26);
+    ASSERT_EQ(house.getDirtyTileCount(),7);
+    ASSERT_EQ(house.getRowBandCount(),1);
+    ASSERT_EQ(house.getRowBandDirt(0),26);
+    house.cleanCurrentLocation();
+    ASSERT_EQ(house.getTotalDirt(),26);
+    house.move(Step::South);
+    house.cleanCurrentLocation();
+    ASSERT_EQ(house.getTotalDirt(),25);
+    ASSERT_EQ(house.getDirtyTileCount(),6);
+    ASSERT_EQ(house.getRowBandDirt(0),25);
+    house.cleanCurrentLocation();
+    ASSERT_EQ(house.getTotalDirt(),25);
+    ASSERT_EQ(house.getDirtyTileCount(),6);
+    house.move(Step::East);
+    house.cleanCurrentLocation();
+    ASSERT_EQ(house.getTotalDirt(),24);
+    ASSERT_EQ(house.getDirtyTileCount(),6);
+}
+TEST(HouseTest, isWall)
+{
+    uint32_t rows = 3;
+    uint32_t cols = 3;
+    std::vector<std::string> houseLocations = { 
+        { 'W',  '1',  '2'},
+        { 'D', '3', 'W'},
+        { '6',  '7',  '8'}
+    };
+    VacuumHouse house(houseLocations,rows,cols);
+    EXPECT_TRUE(house.isWall(Direction::North));
+    EXPECT_TRUE(house.isWall(Direction::West));
+    EXPECT_FALSE(house.isWall(Direction::East));
+    EXPECT_FALSE(house.isWall(Direction::South));
+    house.move(Step::East);
+    EXPECT_FALSE(house.isWall(Direction::North));
+    EXPECT_TRUE(house.isWall(Direction::East));
+    EXPECT_FALSE(house.isWall(Direction::West));
+    EXPECT_FALSE(house.is_move(Step::East));
+    EXPECT_TRUE(house.is_move(Step::Stay));
+    house.move(Step::North);
+    EXPECT_TRUE(house.isWall(Direction::North));
+    EXPECT_FALSE(house.isWall(Direction::East));
+    SensorReadings readings{house.getWallMask(), house.dirtLevel(), 0};
+    for (auto direction : {Direction::North, Direction::East, Direction::South, Direction::West}) {
+        EXPECT_EQ(readings.isWall(direction), house.isWall(direction));
+    }
+}
+TEST(HouseTest, copiesCleanIndependently)
+{
+    uint32_t rows = 2;
+    uint32_t cols = 2;
+    std::vector<std::string> houseLocations = { 
+        { 'D',  '4'},
+        { '2',  '0'}
+    };
+    VacuumHouse house(houseLocations,rows,cols);
+    VacuumHouse copy(house);
+    copy.move(Step::East);
+    copy.cleanCurrentLocation();
+    copy.cleanCurrentLocation();
+    ASSERT_EQ(copy.getTotalDirt(),4);
+    ASSERT_EQ(copy.getCurrentLocation().getDirtLevel(),2);
+    ASSERT_EQ(house.getTotalDirt(),6);
+    ASSERT_EQ(house.getRowBandDirt(0),6);
+    house.move(Step::East);
+    ASSERT_EQ(house.getCurrentLocation().getDirtLevel(),4);
+    house.cleanCurrentLocation();
+    ASSERT_EQ(house.getTotalDirt(),5);
+    ASSERT_EQ(copy.getTotalDirt(),4);
+}
+TEST(HouseTest, readsDoNotChangeHouse)
+{
+    uint32_t rows = 2;
+    uint32_t cols = 2;
+    std::vector<std::string> houseLocations = { 
+        { 'D',  '4'},
+        { '2',  '0'}
+    };
+    VacuumHouse house(houseLocations,rows,cols);
+    auto location = house.getDirectionLocation(Direction::East);
+    location.setDirtLevel(0);
+    ASSERT_EQ(house.getDirectionLocation(Direction::East).getDirtLevel(),4);
+    ASSERT_EQ(house.getTotalDirt(),6);
+    ASSERT_EQ(house.getDirtyTileCount(),2);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "VacuumParser.hpp"
+#include <fstream>
 
 class VacuumParserTest : public ::testing::Test {
 protected:
@@ -55,4 +56,17 @@ TEST_F(VacuumParserTest, CheckParsing)
     ASSERT_TRUE(vacuum->getHouse().isWall(Direction::North));
     ASSERT_TRUE(vacuum->getHouse().isWall(Direction::South));
 
-}
\ No newline at end of file
+}TEST_F(VacuumParserTest, HeaderOfInvalidHouseIsSilent)
+{
+    auto filepath = std::filesystem::temp_directory_path() / "house-header-overflow.house";
+    {
+        std::ofstream file(filepath);
+        file << "overflow\nMaxSteps = 99999999999999\nMaxBattery = 10\nRows = 1\nCols = 1\nD\n";
+    }
+    testing::internal::CaptureStderr();
+    auto header = parser.parseHeader(filepath);
+    auto errors = testing::internal::GetCapturedStderr();
+    std::filesystem::remove(filepath);
+    ASSERT_FALSE(header.has_value());
+    ASSERT_EQ(errors, "");
+}
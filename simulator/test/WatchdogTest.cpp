@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "Watchdog.hpp"
+#include <atomic>
+#include <thread>
+
+TEST(WatchdogTest, FiresExpiredDeadline)
+{
+    Watchdog watchdog;
+    std::atomic<bool> timedOut = false;
+    watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(20), [&timedOut]() { timedOut = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_TRUE(timedOut);
+    ASSERT_EQ(watchdog.armedCount(), 0);
+}
+TEST(WatchdogTest, DisarmedDeadlineNeverFires)
+{
+    Watchdog watchdog;
+    std::atomic<bool> timedOut = false;
+    auto deadline = watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(50), [&timedOut]() { timedOut = true; });
+    ASSERT_EQ(watchdog.armedCount(), 1);
+    watchdog.disarm(deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    ASSERT_FALSE(timedOut);
+}
+TEST(WatchdogTest, EarlierDeadlineWakesWatchdog)
+{
+    Watchdog watchdog;
+    std::atomic<int> fired = 0;
+    std::atomic<bool> late = false;
+    auto lateDeadline = watchdog.arm(Watchdog::Clock::now() + std::chrono::seconds(60), [&late]() { late = true; });
+    watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(20), [&fired]() { fired++; });
+    watchdog.arm(Watchdog::Clock::now() + std::chrono::milliseconds(10), [&fired]() { fired++; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(fired, 2);
+    ASSERT_FALSE(late);
+    watchdog.disarm(lateDeadline);
+}
+TEST(WatchdogTest, RecheckedDeadlineMovesUntilDone)
+{
+    Watchdog watchdog;
+    std::atomic<int> checks = 0;
+    watchdog.armRechecked(Watchdog::Clock::now() + std::chrono::milliseconds(10), [&checks]() -> std::optional<Watchdog::Clock::time_point> {
+        if (++checks < 3)
+        {
+            return Watchdog::Clock::now() + std::chrono::milliseconds(10);
+        }
+        return std::nullopt;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_EQ(checks, 3);
+    ASSERT_EQ(watchdog.armedCount(), 0);
+}
+TEST(WatchdogTest, CpuTimeIgnoresWaiting)
+{
+    Watchdog watchdog;
+    std::atomic<bool> timedOut = false;
+    auto deadline = watchdog.armCpuTime(std::chrono::milliseconds(50), std::chrono::seconds(60), [&timedOut]() { timedOut = true; });
+    // Sleeping uses no CPU time, so this thread is still within its limit
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_FALSE(timedOut);
+    auto start = Watchdog::Clock::now();
+    while (!timedOut && Watchdog::Clock::now() - start < std::chrono::seconds(5))
+    {
+    }
+    ASSERT_TRUE(timedOut);
+    watchdog.disarm(deadline);
+}
+TEST(WatchdogTest, CpuTimeBackstop)
+{
+    Watchdog watchdog;
+    std::atomic<bool> timedOut = false;
+    watchdog.armCpuTime(std::chrono::seconds(60), std::chrono::milliseconds(50), [&timedOut]() { timedOut = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_TRUE(timedOut);
+}
+TEST(WatchdogTest, CpuTimeOfExitedThreadFallsBackToWallTime)
+{
+    Watchdog watchdog;
+    std::atomic<bool> timedOut = false;
+    std::thread([&]() { watchdog.armCpuTime(std::chrono::milliseconds(50), std::chrono::seconds(60), [&timedOut]() { timedOut = true; }); }).join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_TRUE(timedOut);
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "WorkStealingPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST(WorkStealingPoolTest, RunsEverySubmittedJob)
+{
+    std::atomic<int> done = 0;
+    {
+        WorkStealingPool pool(4);
+        ASSERT_EQ(pool.size(), 4);
+        for (int i = 0; i < 1000; i++)
+        {
+            pool.submit([&done]() { done++; });
+        }
+        pool.wait();
+        ASSERT_EQ(done, 1000);
+    }
+    ASSERT_EQ(done, 1000);
+}
+TEST(WorkStealingPoolTest, IdleWorkerStealsQueuedJobs)
+{
+    WorkStealingPool pool(2);
+    std::atomic<int> done = 0;
+    std::atomic<bool> stolen = false;
+    // The first worker is stuck on this job, the jobs queued behind it can only finish if the second worker steals them
+    pool.submit([&]() {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (done < 3 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        stolen = done == 3;
+    });
+    for (int i = 0; i < 3; i++)
+    {
+        pool.submit([&done]() { done++; });
+    }
+    pool.wait();
+    ASSERT_TRUE(stolen);
+}
+TEST(WorkStealingPoolTest, SurvivesThrowingJob)
+{
+    WorkStealingPool pool(1);
+    std::atomic<int> done = 0;
+    pool.submit([]() { throw std::runtime_error("job failed"); });
+    pool.submit([&done]() { done++; });
+    pool.wait();
+    ASSERT_EQ(done, 1);
+}
@@ -3,9 +3,56 @@
 #include <filesystem>
 #include <dlfcn.h>
 #include "AlgorithmRegistrar.h"
+#include "ChargingAlgorithm.h"
+#include "SensorSnapshot.h"
+/**
+ * Hides PlanningAlgorithm from the simulator, so every step of the run comes from nextStep
+ */
+class StepByStepAlgorithm : public AbstractAlgorithm, public ChargingAlgorithm, public SensorSnapshotAlgorithm
+{
+public:
+    StepByStepAlgorithm(std::unique_ptr<AbstractAlgorithm> algorithm) : algorithm(std::move(algorithm)) {}
+    void setMaxSteps(std::size_t maxSteps) override { algorithm->setMaxSteps(maxSteps); }
+    void setWallsSensor(const WallsSensor &sensor) override { algorithm->setWallsSensor(sensor); }
+    void setDirtSensor(const DirtSensor &sensor) override { algorithm->setDirtSensor(sensor); }
+    void setBatteryMeter(const BatteryMeter &meter) override { algorithm->setBatteryMeter(meter); }
+    void setSensorSnapshot(const SensorSnapshot &snapshot) override { dynamic_cast<SensorSnapshotAlgorithm &>(*algorithm).setSensorSnapshot(snapshot); }
+    std::size_t takeChargeSteps(std::size_t maxChargeSteps) override { return dynamic_cast<ChargingAlgorithm &>(*algorithm).takeChargeSteps(maxChargeSteps); }
+    Step nextStep() override { return algorithm->nextStep(); }
+private:
+    std::unique_ptr<AbstractAlgorithm> algorithm;
+};
 class SpecificAlgorithmTest : public ::testing::Test
 {
 protected:
+    /**
+     * Runs the algorithm on every house of the directory once handing out planned paths and once step by step,
+     * the two runs have to take the very same steps
+     */
+    void ExpectPlanMatchesStepByStep(std::filesystem::path houseDirectory, std::filesystem::path algorithmPath)
+    {
+        if (!dlopen(algorithmPath.c_str(), RTLD_LAZY | RTLD_GLOBAL))
+        {
+            FAIL() << "Failed to open the algorithm file " << dlerror();
+        }
+        auto &factory = *AlgorithmRegistrar::getAlgorithmRegistrar().begin();
+        for (const auto &entry : std::filesystem::directory_iterator(houseDirectory))
+        {
+            VacuumSimulator planned;
+            planned.setAlgorithm(factory.create());
+            planned.readHouseFile(entry.path());
+            planned.run();
+            VacuumSimulator stepByStep;
+            stepByStep.setAlgorithm(std::make_unique<StepByStepAlgorithm>(factory.create()));
+            stepByStep.readHouseFile(entry.path());
+            stepByStep.run();
+            ASSERT_EQ(planned.record->size(), stepByStep.record->size()) << entry.path();
+            for (uint32_t i = 0; i <= planned.record->size(); i++)
+            {
+                ASSERT_EQ((*planned.record)[i].getStep(), (*stepByStep.record)[i].getStep()) << entry.path() << " step " << i;
+            }
+        }
+    }
     virtual void StartTest(std::filesystem::path inputfile,std::filesystem::path algorithmPath)
     {
         filename = inputfile.stem().string();
@@ -20,18 +67,18 @@ protected:
         simulator.readHouseFile(inputfile);
         simulator.run();
         record = simulator.record;
-        ASSERT_EQ(record->last()->getLocationType(), LocationType::CHARGING_STATION);
+        ASSERT_EQ(record->last().getLocationType(), LocationType::CHARGING_STATION);
         auto indecies = record->size();
-        ASSERT_EQ((*record)[indecies].get()->getStep(), Step::Finish);
+        ASSERT_EQ((*record)[indecies].getStep(), Step::Finish);
         if (record->size() != 0)
         {
-            ASSERT_NE((*record)[indecies - 1].get()->getStep(), Step::Stay);
+            ASSERT_NE((*record)[indecies - 1].getStep(), Step::Stay);
         }
         std::filesystem::create_directories(gt);
     }
     void TearDown() override
     {
-        if (!testing::Test::HasFailure())
+        if (!testing::Test::HasFailure() && record)
         {
             auto path = simulator.exportRecord(algoName);
             auto gtPath = gt / (filename + "-" + algoName + ".txt");